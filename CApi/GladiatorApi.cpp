@@ -0,0 +1,216 @@
+#include <cmath>
+#include <numeric>
+#include "GladiatorApi.h"
+#include "../Simulation/Simulation.h"
+#include "../Simulation/EquilibriumSolver.h"
+#include "../Simulation/Executor.h"
+
+namespace {
+    constexpr long long denseStatesLimit = 1LL << 22;
+
+    /* Силы должны быть положительными и конечными: иначе рекуррента делит на ноль. */
+    bool isValidStrengths(const double* strengths, const long long length) {
+        if (strengths == nullptr) {
+            return false;
+        }
+        for (long long i = 0; i < length; i++) {
+            if (!(strengths[i] > 0) || !std::isfinite(strengths[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* Разреженный алгоритм завершает процесс, если номер состояния не помещается в 128 бит. */
+    bool isEstimable(const int* teamLengths, const int teamsNumber) {
+        auto shape = std::vector<StrengthVector>(teamsNumber);
+        for (int t = 0; t < teamsNumber; t++) {
+            shape[t] = StrengthVector(teamLengths[t]);
+        }
+        return (teamsNumber <= 1) || (QualityEstimation::statesNumber(shape) <= denseStatesLimit)
+               || QualityEstimation::isSparseRepresentable(shape);
+    }
+
+    /* Мутации нужны хотя бы два гладиатора, скрещиванию -- хотя бы две отобранные команды. */
+    bool isValidEvolution(const int gladiatorNumber, const int generationNumber, const int epochs,
+                          const double mutationCoefficient) {
+        return (gladiatorNumber >= 2) && (generationNumber >= 2) && (epochs > 0)
+               && (mutationCoefficient > 0) && (mutationCoefficient <= 1)
+               && (std::trunc(generationNumber * mutationCoefficient) >= 2);
+    }
+
+    template <typename Body>
+    int guarded(const Body& body) {
+        /* Исключения не должны пересекать границу C. */
+        try {
+            body();
+            return GLADIATOR_OK;
+        } catch (...) {
+            return GLADIATOR_INTERNAL_ERROR;
+        }
+    }
+}
+
+int gladiator_api_version(void) {
+    return GLADIATOR_API_VERSION;
+}
+
+int gladiator_duels(const double* left_teams, const int left_length,
+                    const double* right_teams, const int right_length,
+                    const long long duels_number, double* probabilities, const int threads_number) {
+    if ((left_length <= 0) || (right_length <= 0) || (duels_number < 0) || (threads_number <= 0)
+        || (probabilities == nullptr) || !isValidStrengths(left_teams, duels_number * left_length)
+        || !isValidStrengths(right_teams, duels_number * right_length)) {
+        return GLADIATOR_INVALID_ARGUMENT;
+    }
+    return guarded([&]() {
+        QualityEstimation::probabilitiesOfWinLeftTeam(left_teams, left_length, left_length,
+                                                      right_teams, right_length, right_length,
+                                                      duels_number, probabilities, threads_number);
+    });
+}
+
+int gladiator_duels_against_enemy(const double* teams, const int team_length, const long long teams_number,
+                                  const double* enemy, const int enemy_length,
+                                  double* probabilities, const int threads_number) {
+    if ((team_length <= 0) || (enemy_length <= 0) || (teams_number < 0) || (threads_number <= 0)
+        || (probabilities == nullptr) || !isValidStrengths(teams, teams_number * team_length)
+        || !isValidStrengths(enemy, enemy_length)) {
+        return GLADIATOR_INVALID_ARGUMENT;
+    }
+    return guarded([&]() {
+        QualityEstimation::probabilitiesOfWinLeftTeam(teams, team_length, team_length,
+                                                      enemy, enemy_length, 0,
+                                                      teams_number, probabilities, threads_number);
+    });
+}
+
+int gladiator_tournaments(const double* strengths, const int* team_lengths, const int teams_number,
+                          const long long tournaments_number, double* probabilities, double* dropped_masses,
+                          const int threads_number) {
+    if ((team_lengths == nullptr) || (teams_number <= 0) || (tournaments_number < 0) || (threads_number <= 0)
+        || (probabilities == nullptr)) {
+        return GLADIATOR_INVALID_ARGUMENT;
+    }
+    long long tournamentLength = 0;
+    for (int t = 0; t < teams_number; t++) {
+        if (team_lengths[t] <= 0) {
+            return GLADIATOR_INVALID_ARGUMENT;
+        }
+        tournamentLength += team_lengths[t];
+    }
+    if (!isValidStrengths(strengths, tournaments_number * tournamentLength)) {
+        return GLADIATOR_INVALID_ARGUMENT;
+    }
+    if (!isEstimable(team_lengths, teams_number)) {
+        return GLADIATOR_INVALID_ARGUMENT;
+    }
+
+    return guarded([&]() {
+        /*
+         * Плотный алгоритм по сериям, при большом числе состояний -- разреженный с фронтом
+         * не больше `denseStatesLimit` и отброшенной массой в `dropped_masses`.
+         * Команды турнира копируются в буферы своего отрезка, выделенные один раз на отрезок.
+         */
+        auto shape = std::vector<StrengthVector>(teams_number);
+        for (int t = 0; t < teams_number; t++) {
+            shape[t] = StrengthVector(team_lengths[t]);
+        }
+        auto isSparse = (teams_number > 1) && (QualityEstimation::statesNumber(shape) > denseStatesLimit);
+        auto chunksNumber = (int) std::max(1LL, std::min<long long>(threads_number, tournaments_number));
+        Executor::parallelFor(chunksNumber, chunksNumber, [&](const int chunk) {
+            auto begin = tournaments_number * chunk / chunksNumber;
+            auto end = tournaments_number * (chunk + 1) / chunksNumber;
+            auto teams = shape;
+            auto compressedTeams = std::vector<RunLengthTeam>(teams_number);
+            for (auto tournament = begin; tournament < end; tournament++) {
+                auto offset = strengths + tournament * tournamentLength;
+                for (int t = 0; t < teams_number; t++) {
+                    for (int i = 0; i < team_lengths[t]; i++) {
+                        teams[t][i] = offset[i];
+                    }
+                    offset += team_lengths[t];
+                }
+                auto result = probabilities + tournament * teams_number;
+                double droppedMass = 0;
+                if (teams_number == 1) {
+                    result[0] = 1;
+                } else if (isSparse) {
+                    auto sparseProbabilities = QualityEstimation::probabilitiesOfWinSparse(teams, 0, denseStatesLimit);
+                    std::copy(sparseProbabilities.probabilities.begin(), sparseProbabilities.probabilities.end(), result);
+                    droppedMass = sparseProbabilities.droppedMass;
+                } else {
+                    for (int t = 0; t < teams_number; t++) {
+                        compressedTeams[t] = RunLengthTeam(teams[t]);
+                    }
+                    auto denseProbabilities = QualityEstimation::probabilitiesOfWin(compressedTeams);
+                    std::copy(denseProbabilities.begin(), denseProbabilities.end(), result);
+                }
+                if (dropped_masses != nullptr) {
+                    dropped_masses[tournament] = droppedMass;
+                }
+            }
+        });
+    });
+}
+
+int gladiator_optimize_team(const double total_strength, const int gladiator_number,
+                            const double* enemy, const int enemy_length,
+                            const int generation_number, const int epochs, const double mutation_coefficient,
+                            const int threads_number, double* team) {
+    if (!(total_strength > 0) || (enemy_length <= 0) || (threads_number <= 0) || (team == nullptr)
+        || !isValidEvolution(gladiator_number, generation_number, epochs, mutation_coefficient)
+        || !isValidStrengths(enemy, enemy_length)) {
+        return GLADIATOR_INVALID_ARGUMENT;
+    }
+    return guarded([&]() {
+        auto enemyTeam = StrengthVector(enemy_length);
+        for (int i = 0; i < enemy_length; i++) {
+            enemyTeam[i] = enemy[i];
+        }
+        auto options = SimulationOptions();
+        options.verbose = false;
+        auto result = Simulation::simulationForOneTeamWithOneEnemy(total_strength, gladiator_number, enemyTeam,
+                                                                   generation_number, epochs, mutation_coefficient,
+                                                                   threads_number, options);
+        std::copy(result.getData(), result.getData() + gladiator_number, team);
+    });
+}
+
+int gladiator_equilibrium(const double* total_strengths, const int* gladiator_numbers, const int teams_number,
+                          const int rounds, const int max_support_size,
+                          const int generation_number, const int epochs, const double mutation_coefficient,
+                          const int threads_number, double* profiles, double* weights, int* support_size,
+                          double* exploitability) {
+    if ((gladiator_numbers == nullptr) || (teams_number < 2) || (rounds <= 0) || (max_support_size <= 0)
+        || (threads_number <= 0) || (profiles == nullptr) || (weights == nullptr) || (support_size == nullptr)
+        || !isValidStrengths(total_strengths, teams_number)) {
+        return GLADIATOR_INVALID_ARGUMENT;
+    }
+    for (int t = 0; t < teams_number; t++) {
+        if (!isValidEvolution(gladiator_numbers[t], generation_number, epochs, mutation_coefficient)) {
+            return GLADIATOR_INVALID_ARGUMENT;
+        }
+    }
+    if (!isEstimable(gladiator_numbers, teams_number)) {
+        return GLADIATOR_INVALID_ARGUMENT;
+    }
+    return guarded([&]() {
+        auto options = SimulationOptions();
+        options.verbose = false;
+        auto result = EquilibriumSolver::solve(std::vector<double>(total_strengths, total_strengths + teams_number),
+                                               std::vector<int>(gladiator_numbers, gladiator_numbers + teams_number),
+                                               rounds, max_support_size, generation_number, epochs,
+                                               mutation_coefficient, threads_number, options);
+        *support_size = result.profiles.size();
+        for (int h = 0; h < result.profiles.size(); h++) {
+            weights[h] = result.weights[h];
+            for (auto& team: result.profiles[h]) {
+                profiles = std::copy(team.getData(), team.getData() + team.getLength(), profiles);
+            }
+        }
+        if (exploitability != nullptr) {
+            *exploitability = result.rounds.back().exploitability;
+        }
+    });
+}
@@ -0,0 +1,78 @@
+/*
+ * C API библиотеки gladiator_core.
+ *
+ * Команды передаются непрерывными массивами вызывающей стороны: пакет из `k` команд
+ * по `length` гладиаторов -- массив `k * length` сил, команда `t` начинается с `t * length`.
+ * Результаты пишутся в буферы вызывающей стороны, библиотека не выделяет память для них
+ * и не сохраняет указатели после возврата. Функции потокобезопасны.
+ * Все функции возвращают GLADIATOR_OK или отрицательный код ошибки.
+ */
+
+#ifndef GLADIATORSIMULATION_GLADIATORAPI_H
+#define GLADIATORSIMULATION_GLADIATORAPI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GLADIATOR_API_VERSION 3
+
+#define GLADIATOR_OK 0
+#define GLADIATOR_INVALID_ARGUMENT (-1)
+#define GLADIATOR_INTERNAL_ERROR (-2)
+
+int gladiator_api_version(void);
+
+/* probabilities[d] -- вероятность победы left_teams[d] над right_teams[d], d < duels_number. */
+int gladiator_duels(const double* left_teams, int left_length,
+                    const double* right_teams, int right_length,
+                    long long duels_number, double* probabilities, int threads_number);
+
+/* probabilities[t] -- вероятность победы teams[t] над одним противником `enemy`. */
+int gladiator_duels_against_enemy(const double* teams, int team_length, long long teams_number,
+                                  const double* enemy, int enemy_length,
+                                  double* probabilities, int threads_number);
+
+/*
+ * Пакет турниров `teams_number` команд с длинами `team_lengths`.
+ * Турнир `s` занимает в `strengths` подряд все свои команды (sum(team_lengths) сил),
+ * probabilities[s * teams_number + t] -- вероятность победы команды `t` в турнире `s`.
+ * Число состояний prod(team_lengths[t] + 1) должно помещаться в 128 бит.
+ * Турниры не больше чем с 2^22 состояниями считаются точно. Большие турниры считаются
+ * разреженным алгоритмом с фронтом не больше 2^22 состояний, и часть массы может быть отброшена:
+ * тогда точная вероятность лежит в [p, p + dropped_masses[s]]. Если `dropped_masses` не NULL,
+ * туда пишется отброшенная масса каждого турнира (0 -- результат точный).
+ */
+int gladiator_tournaments(const double* strengths, const int* team_lengths, int teams_number,
+                          long long tournaments_number, double* probabilities, double* dropped_masses,
+                          int threads_number);
+
+/*
+ * Генетический поиск команды суммарной силы `total_strength` против `enemy`, результат -- в `team`.
+ * Нужны gladiator_number >= 2, 0 < mutation_coefficient <= 1
+ * и trunc(generation_number * mutation_coefficient) >= 2.
+ */
+int gladiator_optimize_team(double total_strength, int gladiator_number,
+                            const double* enemy, int enemy_length,
+                            int generation_number, int epochs, double mutation_coefficient,
+                            int threads_number, double* team);
+
+/*
+ * Смешанное равновесие игры `teams_number` команд с суммарными силами `total_strengths`
+ * и числами гладиаторов `gladiator_numbers` (фиктивная игра, `rounds` раундов).
+ * Носитель смеси -- не более `max_support_size` профилей: профиль `h` занимает в `profiles`
+ * подряд все команды (sum(gladiator_numbers) сил), weights[h] -- его вес, *support_size -- число профилей.
+ * Если `exploitability` не NULL, туда пишется эксплуатируемость последнего раунда.
+ * Ограничения генетического поиска -- как у gladiator_optimize_team, для каждой команды.
+ */
+int gladiator_equilibrium(const double* total_strengths, const int* gladiator_numbers, int teams_number,
+                          int rounds, int max_support_size,
+                          int generation_number, int epochs, double mutation_coefficient,
+                          int threads_number, double* profiles, double* weights, int* support_size,
+                          double* exploitability);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLADIATORSIMULATION_GLADIATORAPI_H */
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include "EnemyEnsemble.h"
+
+void EnemyEnsemble::checkWeights(const std::vector<StrengthVector>& enemies, const std::vector<double>& weights) {
+    if (enemies.empty()) {
+        std::cout << "Empty enemy ensemble" << std::endl;
+        exit(-1);
+    }
+    if (!weights.empty() && (weights.size() != enemies.size())) {
+        std::cout << "Wrong number of weights: " << weights.size() << " for " << enemies.size() << " enemies" << std::endl;
+        exit(-1);
+    }
+    for (auto weight: weights) {
+        if (!(weight >= 0)) {
+            std::cout << "Wrong weight: " << weight << std::endl;
+            exit(-1);
+        }
+    }
+    if (!weights.empty() && (std::accumulate(weights.begin(), weights.end(), 0.0) <= 0)) {
+        std::cout << "All enemy weights are zero" << std::endl;
+        exit(-1);
+    }
+}
+
+EnemyEnsemble::EnemyEnsemble(const std::vector<StrengthVector>& enemies, std::vector<double> weights) {
+    /**
+     * Набор вероятных составов противника с весами.
+     *
+     * Силы всех противников упакованы подряд в один массив,
+     * противники отсортированы по убыванию длины, чтобы соседние задачи
+     * были одинаковой стоимости, а проход по набору шёл по памяти последовательно.
+     * Веса нормируются на единицу, по умолчанию все веса равны.
+     */
+    checkWeights(enemies, weights);
+    if (weights.empty()) {
+        weights = std::vector<double>(enemies.size(), 1.0);
+    }
+    auto weightsSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    originalIndices = std::vector<int>(enemies.size());
+    std::iota(originalIndices.begin(), originalIndices.end(), 0);
+    std::stable_sort(originalIndices.begin(), originalIndices.end(), [&enemies](int i, int j) {
+        return enemies[i].getLength() > enemies[j].getLength();
+    });
+
+    for (auto index: originalIndices) {
+        offsets.push_back(strengths.size());
+        lengths.push_back(enemies[index].getLength());
+        this->weights.push_back(weights[index] / weightsSum);
+        for (int i = 0; i < enemies[index].getLength(); i++) {
+            strengths.push_back(enemies[index][i]);
+        }
+    }
+}
+
+int EnemyEnsemble::getEnemiesNumber() const {
+    return lengths.size();
+}
+
+int EnemyEnsemble::getLength(const int enemy) const {
+    return lengths[enemy];
+}
+
+const double* EnemyEnsemble::getStrengths(const int enemy) const {
+    return strengths.data() + offsets[enemy];
+}
+
+double EnemyEnsemble::getWeight(const int enemy) const {
+    return weights[enemy];
+}
+
+int EnemyEnsemble::getOriginalIndex(const int enemy) const {
+    return originalIndices[enemy];
+}
+
+StrengthVector EnemyEnsemble::getEnemy(const int enemy) const {
+    auto team = StrengthVector(lengths[enemy]);
+    for (int i = 0; i < lengths[enemy]; i++) {
+        team[i] = strengths[offsets[enemy] + i];
+    }
+    return team;
+}
+
+double EnemyEnsemble::aggregate(const std::vector<double>& values, const EnsembleAggregation aggregation) const {
+    /*
+     * Значения `values` перечислены в порядке упаковки противников.
+     * Наихудшее значение берётся только по противникам с ненулевым весом.
+     */
+    if (aggregation == EnsembleAggregation::WorstCase) {
+        auto result = std::numeric_limits<double>::infinity();
+        for (int enemy = 0; enemy < values.size(); enemy++) {
+            if (weights[enemy] > 0) {
+                result = std::min(result, values[enemy]);
+            }
+        }
+        return result;
+    }
+
+    double result = 0;
+    for (int enemy = 0; enemy < values.size(); enemy++) {
+        result += weights[enemy] * values[enemy];
+    }
+    return result;
+}
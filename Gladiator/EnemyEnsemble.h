@@ -0,0 +1,36 @@
+#ifndef GLADIATORSIMULATION_ENEMYENSEMBLE_H
+#define GLADIATORSIMULATION_ENEMYENSEMBLE_H
+
+
+#include <vector>
+#include <iostream>
+#include "StrengthVector.h"
+
+enum class EnsembleAggregation {
+    WeightedAverage,
+    WorstCase
+};
+
+class EnemyEnsemble {
+public:
+    EnemyEnsemble() = default;
+    EnemyEnsemble(const std::vector<StrengthVector>& enemies, std::vector<double> weights=std::vector<double>());
+
+    int getEnemiesNumber() const;
+    int getLength(int enemy) const;
+    const double* getStrengths(int enemy) const;
+    double getWeight(int enemy) const;
+    int getOriginalIndex(int enemy) const;
+    StrengthVector getEnemy(int enemy) const;
+    double aggregate(const std::vector<double>& values, EnsembleAggregation aggregation) const;
+private:
+    std::vector<double> strengths;
+    std::vector<long long> offsets;
+    std::vector<int> lengths;
+    std::vector<double> weights;
+    std::vector<int> originalIndices;
+    static void checkWeights(const std::vector<StrengthVector>& enemies, const std::vector<double>& weights);
+};
+
+
+#endif //GLADIATORSIMULATION_ENEMYENSEMBLE_H
@@ -0,0 +1,69 @@
+#include "PreparedOpponent.h"
+
+PreparedOpponent::PreparedOpponent(const StrengthVector& enemy)
+        : n(enemy.getLength()),
+          runs(enemy) {
+    /**
+     * Противник, подготовленный для многократной оценки команд против него.
+     *
+     * Строится один раз на запуск и может переиспользоваться между запусками
+     * (`SimulationOptions::preparedOpponent`). Хранит силы в выровненных по `alignment`
+     * массивах: в double (его читает и пакетное ядро, по одной силе на столбец для всего блока)
+     * и в float для отбора одинарной точности.
+     * Серии одинаковых гладиаторов (`getRuns`) считаются здесь же.
+     */
+    if (n <= 0) {
+        std::cout << "Empty opponent" << std::endl;
+        exit(-1);
+    }
+    strengths = allocate<double>(n);
+    floatStrengths = allocate<float>(n);
+    for (int i = 0; i < n; i++) {
+        strengths[i] = enemy[i];
+        floatStrengths[i] = (float) enemy[i];
+    }
+}
+
+int PreparedOpponent::getLength() const {
+    return n;
+}
+
+const double* PreparedOpponent::getStrengths() const {
+    return strengths.get();
+}
+
+const float* PreparedOpponent::getFloatStrengths() const {
+    return floatStrengths.get();
+}
+
+const RunLengthTeam& PreparedOpponent::getRuns() const {
+    return runs;
+}
+
+bool PreparedOpponent::isCompressed() const {
+    return runs.getRunsNumber() < n;
+}
+
+bool PreparedOpponent::matches(const StrengthVector& enemy) const {
+    if (enemy.getLength() != n) {
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        if (enemy[i] != strengths[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Scalar>
+PreparedOpponent::AlignedArray<Scalar> PreparedOpponent::allocate(const size_t size) {
+    /* Размер для aligned_alloc должен быть кратен выравниванию. */
+    auto bytes = (size * sizeof(Scalar) + alignment - 1) / alignment * alignment;
+    auto data = static_cast<Scalar*>(std::aligned_alloc(alignment, bytes));
+    if (data == nullptr) {
+        std::cout << "Cannot allocate opponent: " << bytes << " bytes" << std::endl;
+        exit(-1);
+    }
+    return AlignedArray<Scalar>(data);
+}
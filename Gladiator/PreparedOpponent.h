@@ -0,0 +1,43 @@
+#ifndef GLADIATORSIMULATION_PREPAREDOPPONENT_H
+#define GLADIATORSIMULATION_PREPAREDOPPONENT_H
+
+
+#include <cstdlib>
+#include <memory>
+#include "StrengthVector.h"
+#include "RunLengthTeam.h"
+
+class PreparedOpponent {
+public:
+    // Ширина блока пакетного ядра поединков.
+    static constexpr int lanesNumber = 8;
+    static constexpr size_t alignment = 64;
+
+    explicit PreparedOpponent(const StrengthVector& enemy);
+
+    int getLength() const;
+    const double* getStrengths() const;
+    const float* getFloatStrengths() const;
+    const RunLengthTeam& getRuns() const;
+    bool isCompressed() const;
+    bool matches(const StrengthVector& enemy) const;
+private:
+    struct AlignedDeleter {
+        void operator()(void* data) const {
+            std::free(data);
+        }
+    };
+    template <typename Scalar>
+    using AlignedArray = std::unique_ptr<Scalar[], AlignedDeleter>;
+
+    int n;
+    AlignedArray<double> strengths;
+    AlignedArray<float> floatStrengths;
+    RunLengthTeam runs;
+
+    template <typename Scalar>
+    static AlignedArray<Scalar> allocate(size_t size);
+};
+
+
+#endif //GLADIATORSIMULATION_PREPAREDOPPONENT_H
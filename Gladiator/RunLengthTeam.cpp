@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cmath>
+#include "RunLengthTeam.h"
+
+void RunLengthTeam::checkTolerance(const double tolerance) {
+    if (tolerance < 0) {
+        std::cout << "Wrong tolerance: " << tolerance << std::endl;
+        exit(-1);
+    }
+}
+
+RunLengthTeam::RunLengthTeam(const StrengthVector& team, const double tolerance) {
+    /**
+     * Команда в виде списка пар (сила, количество гладиаторов с этой силой).
+     *
+     * Вероятность победы не зависит от порядка гладиаторов в команде,
+     * поэтому силы сортируются и одинаковые объединяются в одну серию,
+     * даже если в исходной команде они стояли не подряд.
+     * Силы, отличающиеся от первой силы серии не более чем на `tolerance` (относительно),
+     * заменяются их средним, суммарная сила команды при этом сохраняется.
+     */
+    checkTolerance(tolerance);
+    this->d = team.getLength();
+
+    auto sortedStrengths = std::vector<double>(d);
+    for (int i = 0; i < d; i++) {
+        sortedStrengths[i] = team[i];
+    }
+    std::sort(sortedStrengths.begin(), sortedStrengths.end());
+
+    for (int i = 0; i < d;) {
+        int j = i;
+        double runSum = 0;
+        while ((j < d) && (std::fabs(sortedStrengths[j] - sortedStrengths[i]) <= tolerance * sortedStrengths[i])) {
+            runSum += sortedStrengths[j];
+            j++;
+        }
+        strengths.push_back(((tolerance == 0) || (j - i == 1)) ? sortedStrengths[i] : runSum / (j - i));
+        counts.push_back(j - i);
+        i = j;
+    }
+}
+
+int RunLengthTeam::getLength() const {
+    return this->d;
+}
+
+int RunLengthTeam::getRunsNumber() const {
+    return counts.size();
+}
+
+double RunLengthTeam::getStrength(const int run) const {
+    return strengths[run];
+}
+
+int RunLengthTeam::getCount(const int run) const {
+    return counts[run];
+}
+
+StrengthVector RunLengthTeam::expand() const {
+    auto team = StrengthVector(d);
+    int position = 0;
+    for (int run = 0; run < counts.size(); run++) {
+        for (int i = 0; i < counts[run]; i++) {
+            team[position++] = strengths[run];
+        }
+    }
+    return team;
+}
+
+void RunLengthTeam::print() const {
+    for (int run = 0; run < counts.size(); run++) {
+        std::cout << strengths[run] << "x" << counts[run] << " ";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,29 @@
+#ifndef GLADIATORSIMULATION_RUNLENGTHTEAM_H
+#define GLADIATORSIMULATION_RUNLENGTHTEAM_H
+
+
+#include <vector>
+#include <iostream>
+#include "StrengthVector.h"
+
+
+class RunLengthTeam {
+public:
+    RunLengthTeam() = default;
+    RunLengthTeam(const StrengthVector& team, double tolerance=0);
+
+    int getLength() const;
+    int getRunsNumber() const;
+    double getStrength(int run) const;
+    int getCount(int run) const;
+    StrengthVector expand() const;
+    void print() const;
+private:
+    int d{0};
+    std::vector<double> strengths;
+    std::vector<int> counts;
+    static void checkTolerance(double tolerance);
+};
+
+
+#endif //GLADIATORSIMULATION_RUNLENGTHTEAM_H
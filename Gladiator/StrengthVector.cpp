@@ -2,17 +2,21 @@
 // Created by xapulc on 13.11.2020.
 //
 
+#include <algorithm>
+#include <cmath>
 #include "StrengthVector.h"
 
-void StrengthVector::checkLength(const int len) {
+template <typename Scalar>
+void BasicStrengthVector<Scalar>::checkLength(const int len) {
     if (len <= 0) {
         std::cout << "Wrong length: " << len << std::endl;
         exit(-1);
     }
 }
 
-void StrengthVector::createElems(const int len, bool fillZeros) {
-    if ((this->elems = std::vector<double>(len)).empty()) {
+template <typename Scalar>
+void BasicStrengthVector<Scalar>::createElems(const int len, bool fillZeros) {
+    if ((this->elems = std::vector<Scalar>(len)).empty()) {
         std::cout << "Cannot allocate enough memory. Length: " << len << std::endl;
         exit(-1);
     }
@@ -23,21 +27,25 @@ void StrengthVector::createElems(const int len, bool fillZeros) {
     }
 }
 
-StrengthVector::StrengthVector(int len) {
+template <typename Scalar>
+BasicStrengthVector<Scalar>::BasicStrengthVector(int len) {
     checkLength(len);
     this->d = len;
     createElems(len);
 }
 
-double &StrengthVector::operator[](const int i) {
+template <typename Scalar>
+Scalar &BasicStrengthVector<Scalar>::operator[](const int i) {
     return (this->elems)[i];
 }
 
-double StrengthVector::operator[](const int i) const {
+template <typename Scalar>
+Scalar BasicStrengthVector<Scalar>::operator[](const int i) const {
     return (this->elems)[i];
 }
 
-StrengthVector &StrengthVector::operator=(const StrengthVector &other) {
+template <typename Scalar>
+BasicStrengthVector<Scalar> &BasicStrengthVector<Scalar>::operator=(const BasicStrengthVector<Scalar> &other) {
     this->d = other.d;
     createElems(d, false);
     for(int i = 0; i < d; i++)
@@ -45,96 +53,164 @@ StrengthVector &StrengthVector::operator=(const StrengthVector &other) {
     return *this;
 }
 
-void StrengthVector::checkLengths(const StrengthVector& left, const StrengthVector& right) {
+template <typename Scalar>
+void BasicStrengthVector<Scalar>::checkLengths(const BasicStrengthVector<Scalar>& left, const BasicStrengthVector<Scalar>& right) {
     if (left.d != right.d) {
         std::cout << "Wrong lengths: " << left.d << "and " << right.d << ")" << std::endl;
         exit(-1);
     }
 }
 
-StrengthVector& StrengthVector::operator+=(const StrengthVector &other) {
+template <typename Scalar>
+BasicStrengthVector<Scalar>& BasicStrengthVector<Scalar>::operator+=(const BasicStrengthVector<Scalar> &other) {
     checkLengths(*this, other);
     for(int i = 0; i < this->d; i++)
         elems[i] += other.elems[i];
     return *this;
 }
 
-StrengthVector StrengthVector::operator+(const StrengthVector &other) const {
+template <typename Scalar>
+BasicStrengthVector<Scalar> BasicStrengthVector<Scalar>::operator+(const BasicStrengthVector<Scalar> &other) const {
     auto res = *this;
     res += other;
     return res;
 }
 
-StrengthVector& StrengthVector::operator-=(const StrengthVector &other) {
+template <typename Scalar>
+BasicStrengthVector<Scalar>& BasicStrengthVector<Scalar>::operator-=(const BasicStrengthVector<Scalar> &other) {
     checkLengths(*this, other);
     for(int i = 0; i < this->d; i++)
         elems[i] -= other.elems[i];
     return *this;
 }
 
-StrengthVector StrengthVector::operator-(const StrengthVector &other) const {
+template <typename Scalar>
+BasicStrengthVector<Scalar> BasicStrengthVector<Scalar>::operator-(const BasicStrengthVector<Scalar> &other) const {
     auto res = *this;
     res -= other;
     return res;
 }
 
-StrengthVector& StrengthVector::operator*=(const StrengthVector &other) {
+template <typename Scalar>
+BasicStrengthVector<Scalar>& BasicStrengthVector<Scalar>::operator*=(const BasicStrengthVector<Scalar> &other) {
     checkLengths(*this, other);
     for(int i = 0; i < this->d; i++)
         elems[i] *= other.elems[i];
     return *this;
 }
 
-StrengthVector StrengthVector::operator*(const StrengthVector &other) const {
+template <typename Scalar>
+BasicStrengthVector<Scalar> BasicStrengthVector<Scalar>::operator*(const BasicStrengthVector<Scalar> &other) const {
     auto res = *this;
     res *= other;
     return res;
 }
 
-StrengthVector& StrengthVector::operator/=(const StrengthVector &other) {
+template <typename Scalar>
+BasicStrengthVector<Scalar>& BasicStrengthVector<Scalar>::operator/=(const BasicStrengthVector<Scalar> &other) {
     checkLengths(*this, other);
     for(int i = 0; i < this->d; i++)
         elems[i] /= other.elems[i];
     return *this;
 }
 
-StrengthVector StrengthVector::operator/(const StrengthVector &other) const {
+template <typename Scalar>
+BasicStrengthVector<Scalar> BasicStrengthVector<Scalar>::operator/(const BasicStrengthVector<Scalar> &other) const {
     auto res = *this;
     res /= other;
     return res;
 }
 
-StrengthVector& StrengthVector::operator*=(const double a) {
+template <typename Scalar>
+BasicStrengthVector<Scalar>& BasicStrengthVector<Scalar>::operator*=(const double a) {
     for(int i = 0; i < this->d; i++)
         elems[i] *= a;
     return *this;
 }
 
-StrengthVector StrengthVector::operator*(const double a) const {
+template <typename Scalar>
+BasicStrengthVector<Scalar> BasicStrengthVector<Scalar>::operator*(const double a) const {
     auto res = *this;
     res *= a;
     return res;
 }
 
-StrengthVector& StrengthVector::operator/=(const double a) {
+template <typename Scalar>
+BasicStrengthVector<Scalar>& BasicStrengthVector<Scalar>::operator/=(const double a) {
     for(int i = 0; i < this->d; i++)
         elems[i] /= a;
     return *this;
 }
 
-StrengthVector StrengthVector::operator/(const double a) const {
+template <typename Scalar>
+BasicStrengthVector<Scalar> BasicStrengthVector<Scalar>::operator/(const double a) const {
     auto res = *this;
     res /= a;
     return res;
 }
 
-void StrengthVector::print() const {
+template <typename Scalar>
+void BasicStrengthVector<Scalar>::print() const {
     for(int i = 0; i < this->d; i++) {
         std::cout << (*this)[i] << " ";
     }
     std::cout << std::endl;
 }
 
-int StrengthVector::getLength() const {
+template <typename Scalar>
+int BasicStrengthVector<Scalar>::getLength() const {
     return this->d;
 }
+
+template <typename Scalar>
+const Scalar* BasicStrengthVector<Scalar>::getData() const {
+    return this->elems.data();
+}
+
+template <typename Scalar>
+size_t BasicStrengthVector<Scalar>::hash() const {
+    size_t seed = std::hash<int>()(this->d);
+    for(int i = 0; i < this->d; i++)
+        seed ^= std::hash<Scalar>()(elems[i]) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+template <typename Scalar>
+BasicStrengthVector<Scalar> BasicStrengthVector<Scalar>::canonical() const {
+    /* Вероятность победы не зависит от порядка гладиаторов, поэтому каноническая форма -- силы по убыванию. */
+    auto result = *this;
+    std::sort(result.elems.begin(), result.elems.end(), std::greater<Scalar>());
+    return result;
+}
+
+template <typename Scalar>
+size_t BasicStrengthVector<Scalar>::hash(const double tolerance) const {
+    /* Хэш сил, округлённых до кратных `tolerance`; при `tolerance` = 0 -- точный хэш. */
+    if (tolerance <= 0) {
+        return hash();
+    }
+    size_t seed = std::hash<int>()(this->d);
+    for (int i = 0; i < this->d; i++) {
+        seed ^= std::hash<long long>()(std::llround(elems[i] / tolerance)) + 0x9e3779b97f4a7c15ULL
+                + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+template <typename Scalar>
+bool BasicStrengthVector<Scalar>::isSame(const BasicStrengthVector& other, const double tolerance) const {
+    /* Равенство сил, округлённых как в `hash(tolerance)`: команды с равными хэшами могут оказаться разными. */
+    if (this->d != other.d) {
+        return false;
+    }
+    for (int i = 0; i < this->d; i++) {
+        if ((tolerance <= 0) ? (elems[i] != other.elems[i])
+                             : (std::llround(elems[i] / tolerance) != std::llround(other.elems[i] / tolerance))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template class BasicStrengthVector<double>;
+template class BasicStrengthVector<float>;
@@ -7,38 +7,55 @@
 
 #include <vector>
 #include <iostream>
+#include <functional>
 
 
-class StrengthVector {
+template <typename Scalar>
+class BasicStrengthVector {
 public:
-    StrengthVector() = default;
-    StrengthVector(int len);
-
-    double &operator[](int i);
-    double operator[](int i) const;
-    StrengthVector& operator=(const StrengthVector& other);
-    StrengthVector& operator+=(const StrengthVector& other);
-    StrengthVector operator+(const StrengthVector& other) const;
-    StrengthVector& operator-=(const StrengthVector& other);
-    StrengthVector operator-(const StrengthVector& other) const;
-    StrengthVector& operator*=(const StrengthVector& other);
-    StrengthVector operator*(const StrengthVector& other) const;
-    StrengthVector& operator/=(const StrengthVector& other);
-    StrengthVector operator/(const StrengthVector& other) const;
-    StrengthVector& operator*=(double a);
-    StrengthVector operator*(double a) const;
-    StrengthVector& operator/=(double a);
-    StrengthVector operator/(double a) const;
+    BasicStrengthVector() = default;
+    BasicStrengthVector(const BasicStrengthVector& other) = default;
+    BasicStrengthVector(int len);
+    template <typename Other>
+    explicit BasicStrengthVector(const BasicStrengthVector<Other>& other) : BasicStrengthVector(other.getLength()) {
+        for (int i = 0; i < d; i++) {
+            elems[i] = (Scalar) other[i];
+        }
+    }
+
+    Scalar &operator[](int i);
+    Scalar operator[](int i) const;
+    BasicStrengthVector& operator=(const BasicStrengthVector& other);
+    BasicStrengthVector& operator+=(const BasicStrengthVector& other);
+    BasicStrengthVector operator+(const BasicStrengthVector& other) const;
+    BasicStrengthVector& operator-=(const BasicStrengthVector& other);
+    BasicStrengthVector operator-(const BasicStrengthVector& other) const;
+    BasicStrengthVector& operator*=(const BasicStrengthVector& other);
+    BasicStrengthVector operator*(const BasicStrengthVector& other) const;
+    BasicStrengthVector& operator/=(const BasicStrengthVector& other);
+    BasicStrengthVector operator/(const BasicStrengthVector& other) const;
+    BasicStrengthVector& operator*=(double a);
+    BasicStrengthVector operator*(double a) const;
+    BasicStrengthVector& operator/=(double a);
+    BasicStrengthVector operator/(double a) const;
     void print() const;
 
     int getLength() const;
+    const Scalar* getData() const;
+    BasicStrengthVector canonical() const;
+    size_t hash() const;
+    size_t hash(double tolerance) const;
+    bool isSame(const BasicStrengthVector& other, double tolerance=0) const;
 private:
     int d{0};
-    std::vector<double> elems;
+    std::vector<Scalar> elems;
     static void checkLength(int len);
-    static void checkLengths(const StrengthVector& left, const StrengthVector& right);
+    static void checkLengths(const BasicStrengthVector& left, const BasicStrengthVector& right);
     void createElems(int len, bool fillZeros = true);
 };
 
+// Силы хранятся в double; BasicStrengthVector<float> -- для быстрого отбора одинарной точности.
+using StrengthVector = BasicStrengthVector<double>;
+
 
 #endif //GLADIATORSIMULATION_STRENGTHVECTOR_H
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "WinProbabilityProtocol.h"
+
+/*
+ * Двоичный протокол запросов вероятностей победы поверх потокового сокета.
+ *
+ * Каждое сообщение -- uint32 длина тела в байтах, затем тело.
+ * Запрос:  uint32 id, uint32 k (число команд), uint32 длины команд [k], double силы гладиаторов подряд.
+ * Ответ:   uint32 id, uint32 k, double вероятности победы команд [k] (k = 0 -- неверный запрос),
+ *          double отброшенная масса: точная вероятность команды лежит в [p, p + отброшенная масса]
+ *          (не 0 только у турниров, посчитанных разреженным алгоритмом с ограниченным фронтом).
+ * Для поединка (k = 2) первая вероятность -- вероятность победы первой команды.
+ * Трудоёмкость запроса (`cost`) -- m n клеток для поединка и \prod (m_l + 1) состояний
+ * для турнира; сервер отвечает k = 0 на запросы дороже своего бюджета.
+ * Числа передаются в порядке байтов машины: сервер и клиенты работают на одном узле.
+ */
+
+int WinProbabilityProtocol::listen(const std::string& socketPath) {
+    auto descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if ((descriptor < 0) || (socketPath.size() >= sizeof(address.sun_path))) {
+        std::cout << "Cannot create socket: " << socketPath << std::endl;
+        exit(-1);
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+    unlink(socketPath.c_str());
+    if ((bind(descriptor, (sockaddr*) &address, sizeof(address)) != 0) || (::listen(descriptor, 128) != 0)) {
+        std::cout << "Cannot listen on socket: " << socketPath << std::endl;
+        exit(-1);
+    }
+    return descriptor;
+}
+
+int WinProbabilityProtocol::connect(const std::string& socketPath) {
+    auto descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if ((descriptor < 0) || (socketPath.size() >= sizeof(address.sun_path))) {
+        std::cout << "Cannot create socket: " << socketPath << std::endl;
+        exit(-1);
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+    if (::connect(descriptor, (sockaddr*) &address, sizeof(address)) != 0) {
+        std::cout << "Cannot connect to socket: " << socketPath << std::endl;
+        exit(-1);
+    }
+    return descriptor;
+}
+
+bool WinProbabilityProtocol::readFully(const int descriptor, char* data, size_t size) {
+    while (size > 0) {
+        auto received = recv(descriptor, data, size, 0);
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+bool WinProbabilityProtocol::readFrame(const int descriptor, std::vector<char>& frame, const uint32_t maxSize) {
+    /* Сообщение длиннее `maxSize` не читается: соединение после него нужно закрыть. */
+    uint32_t size;
+    if (!readFully(descriptor, (char*) &size, sizeof(size)) || (size > std::min(maxSize, maxFrameSize))) {
+        return false;
+    }
+    frame.resize(size);
+    return readFully(descriptor, frame.data(), size);
+}
+
+bool WinProbabilityProtocol::writeFrame(const int descriptor, const std::vector<char>& frame) {
+    auto message = std::vector<char>(sizeof(uint32_t) + frame.size());
+    uint32_t size = frame.size();
+    std::memcpy(message.data(), &size, sizeof(size));
+    std::memcpy(message.data() + sizeof(size), frame.data(), frame.size());
+
+    size_t sent = 0;
+    while (sent < message.size()) {
+        auto result = send(descriptor, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+        if (result <= 0) {
+            return false;
+        }
+        sent += result;
+    }
+    return true;
+}
+
+long long WinProbabilityProtocol::cost(const std::vector<StrengthVector>& teams) {
+    auto lengths = std::vector<uint32_t>(teams.size());
+    for (int t = 0; t < teams.size(); t++) {
+        lengths[t] = teams[t].getLength();
+    }
+    return cost(lengths.data(), lengths.size());
+}
+
+long long WinProbabilityProtocol::cost(const uint32_t* lengths, const uint64_t teamsNumber) {
+    /* Насыщается на максимуме long long. */
+    auto maxCost = std::numeric_limits<long long>::max();
+    if (teamsNumber <= 1) {
+        return 0;
+    }
+    if (teamsNumber == 2) {
+        return ((long long) lengths[0] > maxCost / lengths[1]) ? maxCost : (long long) lengths[0] * lengths[1];
+    }
+    long long result = 1;
+    for (uint64_t t = 0; t < teamsNumber; t++) {
+        if (result > maxCost / ((long long) lengths[t] + 1)) {
+            return maxCost;
+        }
+        result *= (long long) lengths[t] + 1;
+    }
+    return result;
+}
+
+std::vector<char> WinProbabilityProtocol::encodeRequest(const uint32_t id, const std::vector<StrengthVector>& teams) {
+    uint32_t teamsNumber = teams.size();
+    size_t gladiatorsNumber = 0;
+    for (auto& team: teams) {
+        gladiatorsNumber += team.getLength();
+    }
+    auto frame = std::vector<char>((2 + teamsNumber) * sizeof(uint32_t) + gladiatorsNumber * sizeof(double));
+    auto words = reinterpret_cast<uint32_t*>(frame.data());
+    words[0] = id;
+    words[1] = teamsNumber;
+    for (int t = 0; t < teamsNumber; t++) {
+        words[2 + t] = teams[t].getLength();
+    }
+    auto offset = (2 + teamsNumber) * sizeof(uint32_t);
+    for (auto& team: teams) {
+        for (int i = 0; i < team.getLength(); i++) {
+            auto strength = team[i];
+            std::memcpy(frame.data() + offset, &strength, sizeof(double));
+            offset += sizeof(double);
+        }
+    }
+    return frame;
+}
+
+bool WinProbabilityProtocol::decodeRequest(const std::vector<char>& frame, uint32_t& id, std::vector<StrengthVector>& teams,
+                                           const long long maxCost) {
+    if (frame.size() < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+    auto words = reinterpret_cast<const uint32_t*>(frame.data());
+    id = words[0];
+    uint64_t teamsNumber = words[1];
+    if (frame.size() < (2 + teamsNumber) * sizeof(uint32_t)) {
+        return false;
+    }
+    uint64_t gladiatorsNumber = 0;
+    for (int t = 0; t < teamsNumber; t++) {
+        if (words[2 + t] == 0) {
+            return false;
+        }
+        gladiatorsNumber += words[2 + t];
+    }
+    auto offset = (2 + teamsNumber) * sizeof(uint32_t);
+    if ((frame.size() != offset + gladiatorsNumber * sizeof(double)) || (cost(words + 2, teamsNumber) > maxCost)) {
+        return false;
+    }
+
+    teams = std::vector<StrengthVector>(teamsNumber);
+    for (int t = 0; t < teamsNumber; t++) {
+        teams[t] = StrengthVector(words[2 + t]);
+        for (int i = 0; i < teams[t].getLength(); i++) {
+            double strength;
+            std::memcpy(&strength, frame.data() + offset, sizeof(double));
+            offset += sizeof(double);
+            if (!(strength > 0)) {
+                return false;
+            }
+            teams[t][i] = strength;
+        }
+    }
+    return true;
+}
+
+std::vector<char> WinProbabilityProtocol::encodeResponse(const uint32_t id, const std::vector<double>& probabilities,
+                                                         const double droppedMass) {
+    auto frame = std::vector<char>(2 * sizeof(uint32_t) + (probabilities.size() + 1) * sizeof(double));
+    auto words = reinterpret_cast<uint32_t*>(frame.data());
+    words[0] = id;
+    words[1] = probabilities.size();
+    auto offset = 2 * sizeof(uint32_t);
+    std::memcpy(frame.data() + offset, probabilities.data(), probabilities.size() * sizeof(double));
+    offset += probabilities.size() * sizeof(double);
+    std::memcpy(frame.data() + offset, &droppedMass, sizeof(double));
+    return frame;
+}
+
+bool WinProbabilityProtocol::decodeResponse(const std::vector<char>& frame, uint32_t& id, std::vector<double>& probabilities,
+                                            double& droppedMass) {
+    if (frame.size() < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+    auto words = reinterpret_cast<const uint32_t*>(frame.data());
+    id = words[0];
+    probabilities = std::vector<double>(words[1]);
+    if (frame.size() != 2 * sizeof(uint32_t) + (probabilities.size() + 1) * sizeof(double)) {
+        return false;
+    }
+    auto offset = 2 * sizeof(uint32_t);
+    std::memcpy(probabilities.data(), frame.data() + offset, probabilities.size() * sizeof(double));
+    offset += probabilities.size() * sizeof(double);
+    std::memcpy(&droppedMass, frame.data() + offset, sizeof(double));
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef GLADIATORSIMULATION_WINPROBABILITYPROTOCOL_H
+#define GLADIATORSIMULATION_WINPROBABILITYPROTOCOL_H
+
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include "../Gladiator/StrengthVector.h"
+
+class WinProbabilityProtocol {
+public:
+    static int listen(const std::string& socketPath);
+    static int connect(const std::string& socketPath);
+
+    static bool readFrame(int descriptor, std::vector<char>& frame, uint32_t maxSize=maxFrameSize);
+    static bool writeFrame(int descriptor, const std::vector<char>& frame);
+
+    static long long cost(const std::vector<StrengthVector>& teams);
+    static std::vector<char> encodeRequest(uint32_t id, const std::vector<StrengthVector>& teams);
+    static bool decodeRequest(const std::vector<char>& frame, uint32_t& id, std::vector<StrengthVector>& teams,
+                              long long maxCost=std::numeric_limits<long long>::max());
+    static std::vector<char> encodeResponse(uint32_t id, const std::vector<double>& probabilities,
+                                            double droppedMass=0);
+    static bool decodeResponse(const std::vector<char>& frame, uint32_t& id, std::vector<double>& probabilities,
+                               double& droppedMass);
+private:
+    static constexpr uint32_t maxFrameSize = 1u << 26;
+
+    static bool readFully(int descriptor, char* data, size_t size);
+    static long long cost(const uint32_t* lengths, uint64_t teamsNumber);
+};
+
+
+#endif //GLADIATORSIMULATION_WINPROBABILITYPROTOCOL_H
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "WinProbabilityServer.h"
+#include "../Simulation/Executor.h"
+#include "../Simulation/LargeDuelEstimation.h"
+
+WinProbabilityServer::Connection::Connection(const int descriptor) : descriptor(descriptor) {}
+
+WinProbabilityServer::Connection::~Connection() {
+    /* Сокет закрывается, когда отвечены все запросы соединения и поток чтения завершился. */
+    close(descriptor);
+}
+
+WinProbabilityServer::WinProbabilityServer(std::string socketPath,
+                                           const int threadsNumber,
+                                           const std::chrono::microseconds batchWindow,
+                                           const int maxBatchSize,
+                                           const long long denseStatesLimit,
+                                           const long long maxQueryCost,
+                                           const uint32_t maxFrameSize)
+        : socketPath(std::move(socketPath)), threadsNumber(threadsNumber), batchWindow(batchWindow),
+          maxBatchSize(maxBatchSize), denseStatesLimit(denseStatesLimit), maxQueryCost(maxQueryCost),
+          maxFrameSize(maxFrameSize) {
+    /**
+     * Сервер вероятностей победы на Unix-сокете `socketPath` (протокол -- WinProbabilityProtocol).
+     *
+     * Каждое соединение читает свой поток, запросы всех соединений попадают в общую очередь.
+     * Поток пакетирования ждёт первый запрос, затем копит очередь не дольше `batchWindow`
+     * или до `maxBatchSize` запросов и считает пакет целиком:
+     * поединки -- пакетным ядром QualityEstimation в `threadsNumber` потоков,
+     * турниры нескольких команд -- плотным алгоритмом или, при числе состояний больше
+     * `denseStatesLimit`, разреженным с фронтом не больше `denseStatesLimit` состояний;
+     * отброшенная им масса передаётся в ответе.
+     *
+     * Запросы дороже `maxQueryCost` (WinProbabilityProtocol::cost) получают ответ k = 0,
+     * соединение с сообщением длиннее `maxFrameSize` байт закрывается.
+     * Запросы дороже `denseStatesLimit` считаются по одному отдельным потоком,
+     * чтобы не задерживать пакеты остальных запросов.
+     */
+    if ((threadsNumber <= 0) || (maxBatchSize <= 0) || (batchWindow.count() < 0) || (maxQueryCost <= 0)
+        || (maxFrameSize == 0)) {
+        std::cout << "Wrong server parameters" << std::endl;
+        exit(-1);
+    }
+}
+
+WinProbabilityServer::~WinProbabilityServer() {
+    stop();
+}
+
+void WinProbabilityServer::run() {
+    /*
+     * Блокирует вызывающий поток до вызова `stop`.
+     *
+     * Потоки чтения отсоединены и держат своё соединение; при остановке
+     * сервер ждёт, пока завершатся все ещё работающие потоки чтения.
+     */
+    auto listener = WinProbabilityProtocol::listen(socketPath);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            close(listener);
+            unlink(socketPath.c_str());
+            return;
+        }
+        listenDescriptor = listener;
+    }
+    auto batcher = std::thread(&WinProbabilityServer::batchLoop, this);
+    auto largeWorker = std::thread(&WinProbabilityServer::largeLoop, this);
+
+    while (true) {
+        auto descriptor = accept(listener, nullptr, nullptr);
+        if (descriptor < 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                break;
+            }
+            continue;
+        }
+        auto connection = std::make_shared<Connection>(descriptor);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            break;
+        }
+        connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                         [](const std::weak_ptr<Connection>& weakConnection) {
+            return weakConnection.expired();
+        }), connections.end());
+        connections.push_back(connection);
+        readersNumber++;
+        std::thread([this, connection]() {
+            serveConnection(connection);
+            /* Оповещение под блокировкой: после неё поток уже не обращается к серверу. */
+            std::lock_guard<std::mutex> lock(mutex);
+            readersNumber--;
+            readersCondition.notify_all();
+        }).detach();
+    }
+
+    {
+        /* Незакрытые клиентами соединения обрываются, чтобы потоки чтения завершились. */
+        std::unique_lock<std::mutex> lock(mutex);
+        for (auto& weakConnection: connections) {
+            if (auto connection = weakConnection.lock()) {
+                shutdown(connection->descriptor, SHUT_RDWR);
+            }
+        }
+        readersCondition.wait(lock, [this]() {
+            return readersNumber == 0;
+        });
+        listenDescriptor = -1;
+    }
+    batcher.join();
+    largeWorker.join();
+    close(listener);
+    unlink(socketPath.c_str());
+}
+
+void WinProbabilityServer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+        if (listenDescriptor >= 0) {
+            shutdown(listenDescriptor, SHUT_RDWR);
+        }
+    }
+    condition.notify_all();
+    largeCondition.notify_all();
+}
+
+long long WinProbabilityServer::getQueriesNumber() const {
+    return queriesNumber.load();
+}
+
+long long WinProbabilityServer::getBatchesNumber() const {
+    return batchesNumber.load();
+}
+
+void WinProbabilityServer::serveConnection(const std::shared_ptr<Connection>& connection) {
+    auto frame = std::vector<char>();
+    while (WinProbabilityProtocol::readFrame(connection->descriptor, frame, maxFrameSize)) {
+        auto query = Query{connection, 0, {}};
+        if (!WinProbabilityProtocol::decodeRequest(frame, query.id, query.teams, maxQueryCost)) {
+            respond(query, {});
+            continue;
+        }
+        auto isLarge = WinProbabilityProtocol::cost(query.teams) > denseStatesLimit;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            (isLarge ? largeQueries : queries).push_back(std::move(query));
+        }
+        (isLarge ? largeCondition : condition).notify_one();
+    }
+}
+
+void WinProbabilityServer::batchLoop() {
+    while (true) {
+        auto batch = std::vector<Query>();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() {
+                return stopping || !queries.empty();
+            });
+            if (stopping) {
+                return;
+            }
+            /* Окно отсчитывается от пробуждения на первом запросе пакета. */
+            condition.wait_until(lock, std::chrono::steady_clock::now() + batchWindow, [this]() {
+                return stopping || (queries.size() >= maxBatchSize);
+            });
+            auto batchSize = std::min<size_t>(queries.size(), maxBatchSize);
+            batch.reserve(batchSize);
+            for (int i = 0; i < batchSize; i++) {
+                batch.push_back(std::move(queries.front()));
+                queries.pop_front();
+            }
+        }
+        evaluate(batch);
+        queriesNumber += batch.size();
+        batchesNumber++;
+    }
+}
+
+void WinProbabilityServer::largeLoop() {
+    while (true) {
+        auto query = Query();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            largeCondition.wait(lock, [this]() {
+                return stopping || !largeQueries.empty();
+            });
+            if (stopping) {
+                return;
+            }
+            query = std::move(largeQueries.front());
+            largeQueries.pop_front();
+        }
+        auto probabilities = probabilitiesOfWin(query.teams);
+        respond(query, probabilities.probabilities, probabilities.droppedMass);
+        queriesNumber++;
+    }
+}
+
+void WinProbabilityServer::evaluate(std::vector<Query>& batch) {
+    auto duels = std::vector<int>();
+    auto tournaments = std::vector<int>();
+    for (int q = 0; q < batch.size(); q++) {
+        if (batch[q].teams.size() == 2) {
+            duels.push_back(q);
+        } else {
+            tournaments.push_back(q);
+        }
+    }
+
+    if (!duels.empty()) {
+        auto leftTeams = std::vector<StrengthVector>(duels.size());
+        auto rightTeams = std::vector<StrengthVector>(duels.size());
+        for (int d = 0; d < duels.size(); d++) {
+            leftTeams[d] = std::move(batch[duels[d]].teams[0]);
+            rightTeams[d] = std::move(batch[duels[d]].teams[1]);
+        }
+        auto probabilities = QualityEstimation::probabilitiesOfWinLeftTeam(leftTeams, rightTeams, threadsNumber);
+        for (int d = 0; d < duels.size(); d++) {
+            respond(batch[duels[d]], {probabilities[d], 1 - probabilities[d]});
+        }
+    }
+
+    Executor::parallelFor(tournaments.size(), threadsNumber, [this, &batch, &tournaments](const int t) {
+        auto& query = batch[tournaments[t]];
+        auto probabilities = probabilitiesOfWin(query.teams);
+        respond(query, probabilities.probabilities, probabilities.droppedMass);
+    });
+}
+
+SparseProbabilities WinProbabilityServer::probabilitiesOfWin(const std::vector<StrengthVector>& teams) const {
+    if (teams.size() <= 1) {
+        return {std::vector<double>(teams.size(), 1.0)};
+    }
+    if (teams.size() == 2) {
+        auto probability = (WinProbabilityProtocol::cost(teams) >= LargeDuelEstimation::cellsThreshold)
+                           ? LargeDuelEstimation::probabilityOfWinLeftTeam(teams[0], teams[1], threadsNumber)
+                           : QualityEstimation::probabilityOfWinLeftTeam(teams[0], teams[1]);
+        return {{probability, 1 - probability}};
+    }
+    if (QualityEstimation::statesNumber(teams) > denseStatesLimit) {
+        return QualityEstimation::probabilitiesOfWinSparse(teams, 0, denseStatesLimit);
+    }
+    auto compressedTeams = std::vector<RunLengthTeam>(teams.size());
+    for (int i = 0; i < teams.size(); i++) {
+        compressedTeams[i] = RunLengthTeam(teams[i]);
+    }
+    return {QualityEstimation::probabilitiesOfWin(compressedTeams)};
+}
+
+void WinProbabilityServer::respond(const Query& query, const std::vector<double>& probabilities,
+                                   const double droppedMass) {
+    auto frame = WinProbabilityProtocol::encodeResponse(query.id, probabilities, droppedMass);
+    std::lock_guard<std::mutex> lock(query.connection->writeMutex);
+    WinProbabilityProtocol::writeFrame(query.connection->descriptor, frame);
+}
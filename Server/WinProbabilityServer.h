@@ -0,0 +1,78 @@
+#ifndef GLADIATORSIMULATION_WINPROBABILITYSERVER_H
+#define GLADIATORSIMULATION_WINPROBABILITYSERVER_H
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "WinProbabilityProtocol.h"
+#include "../Simulation/QualityEstimation.h"
+
+class WinProbabilityServer {
+public:
+    WinProbabilityServer(std::string socketPath,
+                         int threadsNumber=1,
+                         std::chrono::microseconds batchWindow=std::chrono::microseconds(200),
+                         int maxBatchSize=1024,
+                         long long denseStatesLimit=1LL << 22,
+                         long long maxQueryCost=1LL << 30,
+                         uint32_t maxFrameSize=1u << 20);
+    ~WinProbabilityServer();
+    WinProbabilityServer(const WinProbabilityServer&) = delete;
+    WinProbabilityServer& operator=(const WinProbabilityServer&) = delete;
+
+    void run();
+    void stop();
+
+    long long getQueriesNumber() const;
+    long long getBatchesNumber() const;
+private:
+    struct Connection {
+        int descriptor;
+        std::mutex writeMutex;
+
+        explicit Connection(int descriptor);
+        ~Connection();
+    };
+
+    struct Query {
+        std::shared_ptr<Connection> connection;
+        uint32_t id;
+        std::vector<StrengthVector> teams;
+    };
+
+    std::string socketPath;
+    int threadsNumber;
+    std::chrono::microseconds batchWindow;
+    int maxBatchSize;
+    long long denseStatesLimit;
+    long long maxQueryCost;
+    uint32_t maxFrameSize;
+    int listenDescriptor{-1};
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::condition_variable largeCondition;
+    std::condition_variable readersCondition;
+    std::deque<Query> queries;
+    std::deque<Query> largeQueries;
+    std::vector<std::weak_ptr<Connection>> connections;
+    int readersNumber{0};
+    bool stopping{false};
+    std::atomic<long long> queriesNumber{0};
+    std::atomic<long long> batchesNumber{0};
+
+    void serveConnection(const std::shared_ptr<Connection>& connection);
+    void batchLoop();
+    void largeLoop();
+    void evaluate(std::vector<Query>& batch);
+    SparseProbabilities probabilitiesOfWin(const std::vector<StrengthVector>& teams) const;
+    static void respond(const Query& query, const std::vector<double>& probabilities, double droppedMass=0);
+};
+
+
+#endif //GLADIATORSIMULATION_WINPROBABILITYSERVER_H
@@ -0,0 +1,59 @@
+#include "AsyncSimulation.h"
+
+JobHandle AsyncSimulation::submit(JobDescription job,
+                                  std::function<void(const JobProgress&)> onProgress,
+                                  Executor& executor) {
+    /**
+     * Запуск расчёта `job` без ожидания результата.
+     *
+     * Задание получает свою очередь в общем `executor`: сам расчёт
+     * и все его параллельные части выполняются потоками `executor`,
+     * а не отдельными потоками на каждое задание. Очереди заданий
+     * обслуживаются по кругу. Через `JobHandle::control` задание можно отменить,
+     * `onProgress` вызывается после каждой эпохи. Задания не печатают в `std::cout`:
+     * несколько заданий перемешали бы вывод, ход расчёта сообщается только через `onProgress`.
+     * Предварительный отбор `options.screening` меняет свои счётчики при каждом отборе,
+     * поэтому задание получает свою копию, и одновременные задания не делят его состояние.
+     */
+    auto control = std::make_shared<JobControl>(std::move(onProgress));
+    job.options.jobControl = control;
+    job.options.verbose = false;
+    if (job.options.screening) {
+        job.options.screening = std::make_shared<SurrogateScreening>(*job.options.screening);
+    }
+    auto queue = executor.openQueue();
+    auto result = executor.submit(queue, [job = std::move(job), &executor, queue]() {
+        /* Поток отвязывается, а очередь закрывается и при исключении из расчёта. */
+        struct QueueBinding {
+            Executor& executor;
+            int queue;
+            QueueBinding(Executor& executor, const int queue) : executor(executor), queue(queue) {
+                Executor::bindCurrentThread(&executor, queue);
+            }
+            ~QueueBinding() {
+                Executor::bindCurrentThread(nullptr, -1);
+                executor.closeQueue(queue);
+            }
+        };
+        auto binding = QueueBinding(executor, queue);
+        return run(job);
+    });
+    return JobHandle{result.share(), control};
+}
+
+std::vector<StrengthVector> AsyncSimulation::run(const JobDescription& job) {
+    switch (job.kind) {
+        case JobKind::OneEnemy:
+            return {Simulation::simulationForOneTeamWithOneEnemy(job.totalStrengths[0], job.gladiatorNumbers[0], job.enemy,
+                                                                 job.generationNumber, job.epochs, job.mutationCoefficient,
+                                                                 job.threadsNumber, job.options)};
+        case JobKind::Enemies:
+            return {Simulation::simulationForOneTeamWithEnemies(job.totalStrengths[0], job.gladiatorNumbers[0], job.enemies,
+                                                                job.generationNumber, job.epochs, job.mutationCoefficient,
+                                                                job.threadsNumber, job.options)};
+        default:
+            return Simulation::simulationTeams(job.totalStrengths, job.gladiatorNumbers,
+                                               job.generationNumber, job.epochs, job.mutationCoefficient,
+                                               job.threadsNumber, job.options);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef GLADIATORSIMULATION_ASYNCSIMULATION_H
+#define GLADIATORSIMULATION_ASYNCSIMULATION_H
+
+
+#include "Simulation.h"
+
+enum class JobKind {
+    // Одна команда против `enemy`.
+    OneEnemy,
+    // Одна команда против набора `enemies`.
+    Enemies,
+    // Все команды `totalStrengths` друг против друга.
+    Teams
+};
+
+struct JobDescription {
+    JobKind kind{JobKind::OneEnemy};
+    std::vector<double> totalStrengths;
+    std::vector<int> gladiatorNumbers;
+    StrengthVector enemy;
+    EnemyEnsemble enemies;
+    int generationNumber{10};
+    int epochs{10};
+    double mutationCoefficient{0.5};
+    // Число частей параллельной работы; потоки у всех заданий общие.
+    int threadsNumber{3};
+    SimulationOptions options;
+};
+
+struct JobHandle {
+    // Лучшие команды (одна для `OneEnemy` и `Enemies`).
+    std::shared_future<std::vector<StrengthVector>> result;
+    std::shared_ptr<JobControl> control;
+};
+
+class AsyncSimulation {
+public:
+    static JobHandle submit(JobDescription job,
+                            std::function<void(const JobProgress&)> onProgress=nullptr,
+                            Executor& executor=Executor::shared());
+private:
+    static std::vector<StrengthVector> run(const JobDescription& job);
+};
+
+
+#endif //GLADIATORSIMULATION_ASYNCSIMULATION_H
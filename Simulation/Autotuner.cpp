@@ -0,0 +1,242 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include "Autotuner.h"
+#include "QualityEstimation.h"
+#include "Executor.h"
+
+TunedConfiguration Autotuner::tuneOneEnemy(const int gladiatorNumber,
+                                           const StrengthVector& enemy,
+                                           const int generationNumber,
+                                           const AutotuneOptions& autotuneOptions) {
+    /**
+     * Выбор числа потоков, точности и пакетной оценки для отбора против `enemy`.
+     *
+     * Каждая конфигурация оценивает выборку из min(generationNumber, 256) случайных команд
+     * из `gladiatorNumber` гладиаторов тем же ядром, что и отбор в `Simulation`,
+     * выбирается самая быстрая. Решение сохраняется в файле узла по форме задачи
+     * (длины команд, серии в противнике) и при следующих запусках берётся из него.
+     */
+    auto opponent = PreparedOpponent(enemy);
+    auto isCompressed = opponent.isCompressed();
+    auto shape = "duel:" + std::to_string(gladiatorNumber) + "x" + std::to_string(enemy.getLength())
+                 + (isCompressed ? ":runs" + std::to_string(opponent.getRuns().getRunsNumber()) : "");
+
+    auto sampleSize = std::max(1, std::min(generationNumber, maxSampleSize));
+    auto randomGenerator = std::mt19937(0);
+    auto strengthDistribution = std::uniform_real_distribution<double>(0.1, 1.0);
+    auto teams = std::vector<StrengthVector>(sampleSize, StrengthVector(gladiatorNumber));
+    for (auto& team: teams) {
+        for (int i = 0; i < gladiatorNumber; i++) {
+            team[i] = strengthDistribution(randomGenerator);
+        }
+    }
+    auto scores = std::vector<double>(sampleSize);
+
+    auto evaluate = [&](const TunedConfiguration& configuration, const int begin, const int end) {
+        if (configuration.batchedSelection) {
+            QualityEstimation::probabilitiesOfWinLeftTeam(teams.data() + begin, end - begin, opponent,
+                                                          scores.data() + begin);
+            return;
+        }
+        for (int i = begin; i < end; i++) {
+            scores[i] = (configuration.precision == Precision::Float)
+                        ? QualityEstimation::probabilityOfWinLeftTeam(BasicStrengthVector<float>(teams[i]), opponent)
+                        : QualityEstimation::probabilityOfWinLeftTeam(teams[i], opponent);
+        }
+    };
+    return tune(shape, autotuneOptions, candidates(autotuneOptions, !isCompressed), sampleSize, evaluate);
+}
+
+TunedConfiguration Autotuner::tuneTeams(const std::vector<int>& gladiatorNumbers, const AutotuneOptions& autotuneOptions) {
+    /**
+     * Выбор числа потоков и точности для турниров команд из `gladiatorNumbers` гладиаторов.
+     *
+     * Конфигурации оценивают одну и ту же выборку случайных турниров
+     * плотным алгоритмом по сериям, как `Simulation::simulationTeams`.
+     */
+    auto shape = std::string("teams");
+    for (auto gladiatorNumber: gladiatorNumbers) {
+        shape += ":" + std::to_string(gladiatorNumber);
+    }
+
+    auto sampleSize = maxSampleSize;
+    auto randomGenerator = std::mt19937(0);
+    auto strengthDistribution = std::uniform_real_distribution<double>(0.1, 1.0);
+    auto tournaments = std::vector<std::vector<RunLengthTeam>>(sampleSize);
+    for (auto& tournament: tournaments) {
+        for (auto gladiatorNumber: gladiatorNumbers) {
+            auto team = StrengthVector(gladiatorNumber);
+            for (int i = 0; i < gladiatorNumber; i++) {
+                team[i] = strengthDistribution(randomGenerator);
+            }
+            tournament.emplace_back(team);
+        }
+    }
+
+    auto evaluate = [&tournaments](const TunedConfiguration& configuration, const int begin, const int end) {
+        for (int t = begin; t < end; t++) {
+            if (configuration.precision == Precision::Float) {
+                QualityEstimation::probabilitiesOfWin<float>(tournaments[t]);
+            } else {
+                QualityEstimation::probabilitiesOfWin(tournaments[t]);
+            }
+        }
+    };
+    return tune(shape, autotuneOptions, candidates(autotuneOptions, false), sampleSize, evaluate);
+}
+
+void Autotuner::apply(const TunedConfiguration& configuration, SimulationOptions& options) {
+    /* Число потоков передаётся в `Simulation` отдельным аргументом. */
+    options.selectionPrecision = configuration.precision;
+    options.batchedSelection = configuration.batchedSelection;
+}
+
+std::string Autotuner::defaultCachePath() {
+    char hostName[256] = {};
+    gethostname(hostName, sizeof(hostName) - 1);
+    auto home = std::getenv("HOME");
+    return std::string((home != nullptr) ? home : ".") + "/.gladiator-autotune-" + hostName;
+}
+
+TunedConfiguration Autotuner::tune(const std::string& shape,
+                                   const AutotuneOptions& autotuneOptions,
+                                   const std::vector<TunedConfiguration>& candidates,
+                                   const int sampleSize,
+                                   const std::function<void(const TunedConfiguration&, int, int)>& evaluate) {
+    auto path = autotuneOptions.cachePath.empty() ? defaultCachePath() : autotuneOptions.cachePath;
+    auto key = shape + ":threads" + std::to_string(candidates.back().threadsNumber)
+               + (autotuneOptions.allowFloat ? ":float" : "");
+
+    auto best = TunedConfiguration();
+    if (!autotuneOptions.forceRetune && load(path, key, best)) {
+        return best;
+    }
+
+    for (int c = 0; c < candidates.size(); c++) {
+        auto candidate = candidates[c];
+        candidate.seconds = measure(candidate, sampleSize, evaluate);
+        if (autotuneOptions.verbose) {
+            std::cout << "Autotune " << key << ": threads " << candidate.threadsNumber
+                      << (candidate.precision == Precision::Float ? ", float" : ", double")
+                      << (candidate.batchedSelection ? ", batched" : "")
+                      << " -- " << candidate.seconds * 1e6 << " us" << std::endl;
+        }
+        if ((c == 0) || (candidate.seconds < best.seconds)) {
+            best = candidate;
+        }
+    }
+    save(path, key, best);
+    return best;
+}
+
+std::vector<TunedConfiguration> Autotuner::candidates(const AutotuneOptions& autotuneOptions, const bool isBatchable) {
+    /* Числа потоков -- степени двойки и максимальное число; максимальное идёт последним. */
+    auto maxThreadsNumber = (autotuneOptions.maxThreadsNumber > 0) ? autotuneOptions.maxThreadsNumber
+                                                                   : (int) std::thread::hardware_concurrency();
+    maxThreadsNumber = std::max(1, maxThreadsNumber);
+    auto threadsNumbers = std::vector<int>();
+    for (int threadsNumber = 1; threadsNumber < maxThreadsNumber; threadsNumber *= 2) {
+        threadsNumbers.push_back(threadsNumber);
+    }
+    threadsNumbers.push_back(maxThreadsNumber);
+
+    auto result = std::vector<TunedConfiguration>();
+    for (auto threadsNumber: threadsNumbers) {
+        result.push_back({threadsNumber, Precision::Double, false});
+        if (isBatchable) {
+            result.push_back({threadsNumber, Precision::Double, true});
+        }
+        if (autotuneOptions.allowFloat) {
+            result.push_back({threadsNumber, Precision::Float, false});
+        }
+    }
+    std::stable_partition(result.begin(), result.end(), [maxThreadsNumber](const TunedConfiguration& candidate) {
+        return candidate.threadsNumber < maxThreadsNumber;
+    });
+    return result;
+}
+
+double Autotuner::measure(const TunedConfiguration& configuration,
+                          const int sampleSize,
+                          const std::function<void(const TunedConfiguration&, int, int)>& evaluate) {
+    /*
+     * Время одной оценки: выборка делится на `threadsNumber` частей, как в `Simulation::parallelFor`,
+     * и прогоняется, пока суммарное время не превысит `minMeasureSeconds`.
+     * Первый прогон -- разогрев, он не учитывается.
+     */
+    auto chunksNumber = std::min(configuration.threadsNumber, sampleSize);
+    auto runSample = [&]() {
+        Executor::parallelFor(chunksNumber, chunksNumber, [&evaluate, &configuration, sampleSize, chunksNumber](const int chunk) {
+            evaluate(configuration, sampleSize * chunk / chunksNumber, sampleSize * (chunk + 1) / chunksNumber);
+        });
+    };
+
+    runSample();
+    long long runsNumber = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    std::chrono::duration<double> diff{0};
+    while (diff.count() < minMeasureSeconds) {
+        runSample();
+        runsNumber++;
+        diff = std::chrono::steady_clock::now() - start_time;
+    }
+    return diff.count() / ((double) runsNumber * sampleSize);
+}
+
+bool Autotuner::load(const std::string& path, const std::string& key, TunedConfiguration& configuration) {
+    /* Строка файла: ключ, число потоков, точность (0 -- double, 1 -- float), пакетная оценка, время. */
+    auto file = std::ifstream(path);
+    auto line = std::string();
+    while (std::getline(file, line)) {
+        auto stream = std::istringstream(line);
+        auto lineKey = std::string();
+        int precision, batchedSelection;
+        auto candidate = TunedConfiguration();
+        if ((stream >> lineKey >> candidate.threadsNumber >> precision >> batchedSelection >> candidate.seconds)
+            && (lineKey == key) && (candidate.threadsNumber > 0)) {
+            candidate.precision = (precision == 1) ? Precision::Float : Precision::Double;
+            candidate.batchedSelection = (batchedSelection == 1);
+            configuration = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Autotuner::save(const std::string& path, const std::string& key, const TunedConfiguration& configuration) {
+    /* Строка с тем же ключом заменяется; файл пишется во временный и атомарно переименовывается. */
+    auto lines = std::vector<std::string>();
+    {
+        auto file = std::ifstream(path);
+        auto line = std::string();
+        while (std::getline(file, line)) {
+            if (line.substr(0, line.find(' ')) != key) {
+                lines.push_back(line);
+            }
+        }
+    }
+    auto stream = std::ostringstream();
+    stream << key << ' ' << configuration.threadsNumber << ' ' << (configuration.precision == Precision::Float ? 1 : 0)
+           << ' ' << (configuration.batchedSelection ? 1 : 0) << ' ' << configuration.seconds;
+    lines.push_back(stream.str());
+
+    auto temporaryPath = path + ".tmp";
+    {
+        auto file = std::ofstream(temporaryPath);
+        for (auto& line: lines) {
+            file << line << '\n';
+        }
+        if (!file) {
+            std::cout << "Cannot write autotune cache: " << temporaryPath << std::endl;
+            return;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::cout << "Cannot rename autotune cache: " << temporaryPath << std::endl;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef GLADIATORSIMULATION_AUTOTUNER_H
+#define GLADIATORSIMULATION_AUTOTUNER_H
+
+
+#include <functional>
+#include <string>
+#include "../Gladiator/StrengthVector.h"
+#include "SimulationOptions.h"
+
+struct TunedConfiguration {
+    int threadsNumber{1};
+    Precision precision{Precision::Double};
+    bool batchedSelection{false};
+    // Измеренное время одной оценки (поединка или турнира), с.
+    double seconds{0};
+};
+
+struct AutotuneOptions {
+    // Файл решений, пустой -- файл узла в домашнем каталоге.
+    std::string cachePath;
+    // Заново измерить конфигурации, даже если решение уже есть в файле.
+    bool forceRetune{false};
+    // Рассматривать отбор в float; иначе только double.
+    bool allowFloat{false};
+    // Наибольшее число потоков, 0 -- hardware_concurrency.
+    int maxThreadsNumber{0};
+    bool verbose{true};
+};
+
+class Autotuner {
+public:
+    static TunedConfiguration tuneOneEnemy(int gladiatorNumber,
+                                           const StrengthVector& enemy,
+                                           int generationNumber,
+                                           const AutotuneOptions& autotuneOptions=AutotuneOptions());
+    static TunedConfiguration tuneTeams(const std::vector<int>& gladiatorNumbers,
+                                        const AutotuneOptions& autotuneOptions=AutotuneOptions());
+    static void apply(const TunedConfiguration& configuration, SimulationOptions& options);
+    static std::string defaultCachePath();
+private:
+    static constexpr double minMeasureSeconds = 0.02;
+    static constexpr int maxSampleSize = 256;
+
+    static TunedConfiguration tune(const std::string& shape,
+                                   const AutotuneOptions& autotuneOptions,
+                                   const std::vector<TunedConfiguration>& candidates,
+                                   int sampleSize,
+                                   const std::function<void(const TunedConfiguration&, int, int)>& evaluate);
+    static std::vector<TunedConfiguration> candidates(const AutotuneOptions& autotuneOptions, bool isBatchable);
+    static double measure(const TunedConfiguration& configuration,
+                          int sampleSize,
+                          const std::function<void(const TunedConfiguration&, int, int)>& evaluate);
+    static bool load(const std::string& path, const std::string& key, TunedConfiguration& configuration);
+    static void save(const std::string& path, const std::string& key, const TunedConfiguration& configuration);
+};
+
+
+#endif //GLADIATORSIMULATION_AUTOTUNER_H
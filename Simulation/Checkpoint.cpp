@@ -0,0 +1,229 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Checkpoint.h"
+
+void Checkpoint::write(const std::string& path, const CheckpointState& state) {
+    /**
+     * Запись состояния генетического алгоритма в файл `path`.
+     *
+     * Формат (все поля 8-байтовые, файл читается прямо через mmap):
+     *     Header,
+     *     суммарные силы популяций [populationsNumber] (double),
+     *     числа гладиаторов популяций [populationsNumber] (uint64),
+     *     контекст [contextLength] (силы противника для задачи одной команды),
+     *     состояние генератора [randomWordsNumber] (uint64),
+     *     для каждой популяции: силы команд подряд [generationNumber * gladiatorNumber],
+     *     затем их оценки [generationNumber] (NaN для неоценённых команд).
+     * Файл сначала пишется во временный `path.tmp`, затем атомарно переименовывается.
+     */
+    auto populationsNumber = state.generations.size();
+    auto randomWords = saveRandomGenerator(state.randomGenerator);
+    auto header = Header{magic, version, (uint64_t) state.kind, (uint64_t) state.epoch, (uint64_t) state.epochs,
+                         (uint64_t) state.generationNumber, state.mutationCoefficient,
+                         populationsNumber, state.context.size(), randomWords.size()};
+
+    auto fieldsNumber = 2 * populationsNumber + state.context.size() + randomWords.size();
+    for (int p = 0; p < populationsNumber; p++) {
+        fieldsNumber += (size_t) state.generationNumber * (state.gladiatorNumbers[p] + 1);
+    }
+    auto buffer = std::vector<char>(sizeof(Header) + fieldsNumber * sizeof(uint64_t));
+    auto offset = sizeof(Header);
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+    auto put = [&buffer, &offset](const void* data, const size_t size) {
+        std::memcpy(buffer.data() + offset, data, size);
+        offset += size;
+    };
+
+    put(state.totalStrengths.data(), populationsNumber * sizeof(double));
+    for (int p = 0; p < populationsNumber; p++) {
+        auto gladiatorNumber = (uint64_t) state.gladiatorNumbers[p];
+        put(&gladiatorNumber, sizeof(uint64_t));
+    }
+    put(state.context.data(), state.context.size() * sizeof(double));
+    put(randomWords.data(), randomWords.size() * sizeof(uint64_t));
+    for (int p = 0; p < populationsNumber; p++) {
+        for (int i = 0; i < state.generationNumber; i++) {
+            for (int j = 0; j < state.gladiatorNumbers[p]; j++) {
+                auto strength = state.generations[p][i][j];
+                put(&strength, sizeof(double));
+            }
+        }
+        for (int i = 0; i < state.generationNumber; i++) {
+            auto score = (i < state.scores[p].size()) ? state.scores[p][i] : NAN;
+            put(&score, sizeof(double));
+        }
+    }
+
+    auto temporaryPath = path + ".tmp";
+    auto descriptor = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        std::cout << "Cannot open checkpoint: " << temporaryPath << std::endl;
+        exit(-1);
+    }
+    size_t written = 0;
+    while (written < buffer.size()) {
+        auto result = ::write(descriptor, buffer.data() + written, buffer.size() - written);
+        if (result <= 0) {
+            std::cout << "Cannot write checkpoint: " << temporaryPath << std::endl;
+            exit(-1);
+        }
+        written += result;
+    }
+    fsync(descriptor);
+    close(descriptor);
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::cout << "Cannot rename checkpoint: " << temporaryPath << std::endl;
+        exit(-1);
+    }
+}
+
+CheckpointState Checkpoint::read(const std::string& path) {
+    auto descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        std::cout << "Cannot open checkpoint: " << path << std::endl;
+        exit(-1);
+    }
+    struct stat status{};
+    fstat(descriptor, &status);
+    size_t size = status.st_size;
+    auto address = (size >= sizeof(Header)) ? mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+    close(descriptor);
+    if (address == MAP_FAILED) {
+        std::cout << "Cannot map checkpoint: " << path << std::endl;
+        exit(-1);
+    }
+
+    auto mapping = static_cast<const char*>(address);
+    auto header = reinterpret_cast<const Header*>(mapping);
+    if ((header->magic != magic) || (header->version != version)) {
+        std::cout << "Wrong checkpoint format: " << path << std::endl;
+        exit(-1);
+    }
+
+    auto state = CheckpointState();
+    state.kind = (CheckpointKind) header->kind;
+    state.epoch = header->epoch;
+    state.epochs = header->epochs;
+    state.generationNumber = header->generationNumber;
+    state.mutationCoefficient = header->mutationCoefficient;
+
+    auto populationsNumber = header->populationsNumber;
+    auto fields = reinterpret_cast<const double*>(mapping + sizeof(Header));
+    auto words = reinterpret_cast<const uint64_t*>(fields);
+    size_t fieldsNumber = 2 * populationsNumber + header->contextLength + header->randomWordsNumber;
+    for (int p = 0; p < populationsNumber && (sizeof(Header) + fieldsNumber * sizeof(double) <= size); p++) {
+        fieldsNumber += (size_t) state.generationNumber * (words[populationsNumber + p] + 1);
+    }
+    if (sizeof(Header) + fieldsNumber * sizeof(double) != size) {
+        std::cout << "Wrong checkpoint size: " << path << std::endl;
+        exit(-1);
+    }
+
+    state.totalStrengths = std::vector<double>(fields, fields + populationsNumber);
+    state.gladiatorNumbers = std::vector<int>(words + populationsNumber, words + 2 * populationsNumber);
+    auto offset = 2 * populationsNumber;
+    state.context = std::vector<double>(fields + offset, fields + offset + header->contextLength);
+    offset += header->contextLength;
+    loadRandomGenerator(state.randomGenerator, words + offset, header->randomWordsNumber);
+    offset += header->randomWordsNumber;
+
+    state.generations = std::vector<std::vector<StrengthVector>>(populationsNumber);
+    state.scores = std::vector<std::vector<double>>(populationsNumber);
+    for (int p = 0; p < populationsNumber; p++) {
+        state.generations[p] = std::vector<StrengthVector>(state.generationNumber);
+        for (int i = 0; i < state.generationNumber; i++) {
+            state.generations[p][i] = StrengthVector(state.gladiatorNumbers[p]);
+            for (int j = 0; j < state.gladiatorNumbers[p]; j++) {
+                state.generations[p][i][j] = fields[offset++];
+            }
+        }
+        state.scores[p] = std::vector<double>(fields + offset, fields + offset + state.generationNumber);
+        offset += state.generationNumber;
+    }
+
+    munmap(address, size);
+    return state;
+}
+
+std::vector<uint64_t> Checkpoint::saveRandomGenerator(const std::mt19937& randomGenerator) {
+    /* Стандартное текстовое представление генератора: слова состояния и позиция в нём. */
+    std::stringstream stream;
+    stream << randomGenerator;
+    auto words = std::vector<uint64_t>();
+    uint64_t word;
+    while (stream >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+void Checkpoint::loadRandomGenerator(std::mt19937& randomGenerator, const uint64_t* words, const uint64_t wordsNumber) {
+    std::stringstream stream;
+    for (int i = 0; i < wordsNumber; i++) {
+        stream << words[i] << ' ';
+    }
+    stream >> randomGenerator;
+    if (stream.fail()) {
+        std::cout << "Wrong random generator state in checkpoint" << std::endl;
+        exit(-1);
+    }
+}
+
+CheckpointWriter::CheckpointWriter(std::string path) : path(std::move(path)) {
+    /**
+     * Фоновая запись контрольных точек в файл `path`.
+     *
+     * `submit` только передаёт состояние потоку записи и сразу возвращается.
+     * Если поток ещё пишет предыдущую точку, ожидающая точка заменяется новой:
+     * на диске всегда оказывается последнее состояние.
+     * Деструктор дожидается записи ожидающей точки.
+     */
+    worker = std::thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_one();
+    worker.join();
+}
+
+void CheckpointWriter::submit(CheckpointState state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::make_unique<CheckpointState>(std::move(state));
+    }
+    condition.notify_one();
+}
+
+int CheckpointWriter::getWrittenNumber() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writtenNumber;
+}
+
+void CheckpointWriter::run() {
+    while (true) {
+        std::unique_ptr<CheckpointState> state;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() {
+                return stopping || pending;
+            });
+            if (!pending) {
+                return;
+            }
+            state = std::move(pending);
+        }
+        Checkpoint::write(path, *state);
+        std::lock_guard<std::mutex> lock(mutex);
+        writtenNumber++;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef GLADIATORSIMULATION_CHECKPOINT_H
+#define GLADIATORSIMULATION_CHECKPOINT_H
+
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include "../Gladiator/StrengthVector.h"
+
+enum class CheckpointKind {OneEnemy, Teams};
+
+struct CheckpointState {
+    CheckpointKind kind{CheckpointKind::OneEnemy};
+    long long epoch{0};
+    long long epochs{0};
+    int generationNumber{0};
+    double mutationCoefficient{0};
+    std::vector<double> totalStrengths;
+    std::vector<int> gladiatorNumbers;
+    std::vector<double> context;
+    std::vector<std::vector<StrengthVector>> generations;
+    std::vector<std::vector<double>> scores;
+    std::mt19937 randomGenerator;
+};
+
+class Checkpoint {
+public:
+    static void write(const std::string& path, const CheckpointState& state);
+    static CheckpointState read(const std::string& path);
+private:
+    static constexpr uint64_t magic = 0x54504b4344414c47ULL;
+    static constexpr uint64_t version = 1;
+
+    struct Header {
+        uint64_t magic;
+        uint64_t version;
+        uint64_t kind;
+        uint64_t epoch;
+        uint64_t epochs;
+        uint64_t generationNumber;
+        double mutationCoefficient;
+        uint64_t populationsNumber;
+        uint64_t contextLength;
+        uint64_t randomWordsNumber;
+    };
+
+    static std::vector<uint64_t> saveRandomGenerator(const std::mt19937& randomGenerator);
+    static void loadRandomGenerator(std::mt19937& randomGenerator, const uint64_t* words, uint64_t wordsNumber);
+};
+
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(std::string path);
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void submit(CheckpointState state);
+    int getWrittenNumber();
+private:
+    std::string path;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::unique_ptr<CheckpointState> pending;
+    bool stopping{false};
+    int writtenNumber{0};
+    std::thread worker;
+
+    void run();
+};
+
+
+#endif //GLADIATORSIMULATION_CHECKPOINT_H
@@ -0,0 +1,170 @@
+#include "EquilibriumSolver.h"
+
+EquilibriumResult EquilibriumSolver::solve(const std::vector<double>& totalStrengths,
+                                           const std::vector<int>& gladiatorNumbers,
+                                           const int rounds,
+                                           const int maxSupportSize,
+                                           const int generationNumber,
+                                           const int epochs,
+                                           const double mutationCoefficient,
+                                           const int threadsNumber,
+                                           const SimulationOptions& options) {
+    /**
+     * Поиск равновесия игры нескольких команд фиктивной игрой.
+     *
+     * Смесь задаётся носителем -- не более `maxSupportSize` профилей (по команде на каждого
+     * участника) с весами, пропорциональными числу раундов, в которых профиль был сыгран.
+     * В начале носитель -- один профиль из равных по силе гладиаторов.
+     * В каждом раунде для каждой команды генетическим алгоритмом ищется наилучший ответ
+     * на смесь остальных: качество команды -- средняя по профилям носителя вероятность
+     * победы, когда она заменяет в профиле свою команду. Так на одну команду приходится
+     * |носитель| турниров, а не G^N, как в `Simulation::simulationTeams`.
+     * Поиск стартует с лучшей половины поколения предыдущего раунда.
+     * Профиль из найденных ответов добавляется в носитель; при переполнении
+     * удаляется профиль с наименьшим весом (из равных -- самый старый).
+     *
+     * Мерой сходимости служит эксплуатируемость: суммарный выигрыш команд от перехода
+     * со смеси на найденный ответ. Ответ ищется приближённо, поэтому это оценка снизу.
+     */
+    int teamsNumber = totalStrengths.size();
+    if ((teamsNumber < 2) || (gladiatorNumbers.size() != teamsNumber) || (maxSupportSize <= 0)) {
+        std::cout << "Wrong equilibrium parameters" << std::endl;
+        exit(-1);
+    }
+
+    auto profiles = std::vector<std::vector<StrengthVector>>();
+    auto counts = std::vector<double>();
+    auto ages = std::vector<int>();
+    auto initialProfile = std::vector<StrengthVector>(teamsNumber);
+    for (int j = 0; j < teamsNumber; j++) {
+        initialProfile[j] = StrengthVector(gladiatorNumbers[j]);
+        for (int i = 0; i < gladiatorNumbers[j]; i++) {
+            initialProfile[j][i] = totalStrengths[j] / gladiatorNumbers[j];
+        }
+    }
+    addProfile(profiles, counts, ages, initialProfile, 0, maxSupportSize);
+
+    auto result = EquilibriumResult();
+    auto warmStarts = std::vector<std::vector<StrengthVector>>(teamsNumber);
+    auto innerOptions = options;
+    innerOptions.verbose = false;
+
+    for (int round = 0; round < rounds; round++) {
+        if (options.jobControl && options.jobControl->isCancelled()) {
+            break;
+        }
+        double totalCount = 0;
+        for (auto count: counts) {
+            totalCount += count;
+        }
+        auto profileValues = std::vector<std::vector<double>>(profiles.size());
+        auto roundResult = EquilibriumRound{round, std::vector<double>(teamsNumber, 0.0),
+                                            std::vector<double>(teamsNumber, 0.0), 0};
+        for (int h = 0; h < profiles.size(); h++) {
+            profileValues[h] = probabilitiesOfWin(profiles[h], options);
+            for (int j = 0; j < teamsNumber; j++) {
+                roundResult.mixtureValues[j] += counts[h] / totalCount * profileValues[h][j];
+            }
+        }
+
+        auto bestResponses = std::vector<StrengthVector>(teamsNumber);
+        for (int j = 0; j < teamsNumber; j++) {
+            auto fitness = [&profiles, &counts, &options, totalCount, j](const StrengthVector& team) {
+                auto value = 0.0;
+                for (int h = 0; h < profiles.size(); h++) {
+                    auto teams = profiles[h];
+                    teams[j] = team;
+                    value += counts[h] / totalCount * probabilitiesOfWin(teams, options)[j];
+                }
+                return value;
+            };
+            auto seeds = std::vector<StrengthVector>(warmStarts[j].begin(),
+                                                     warmStarts[j].begin() + warmStarts[j].size() / 2);
+            auto generation = Simulation::simulationForOneTeamWithFitness(totalStrengths[j], gladiatorNumbers[j],
+                                                                          fitness, seeds, generationNumber, epochs,
+                                                                          mutationCoefficient, threadsNumber,
+                                                                          innerOptions);
+            bestResponses[j] = generation[0];
+            roundResult.bestResponseValues[j] = fitness(generation[0]);
+            roundResult.exploitability += std::max(0.0, roundResult.bestResponseValues[j]
+                                                        - roundResult.mixtureValues[j]);
+            warmStarts[j] = std::move(generation);
+        }
+
+        if (options.verbose) {
+            std::cout << "Round " << round << ": exploitability " << roundResult.exploitability
+                      << ", support " << profiles.size() << "; best responses:";
+            for (int j = 0; j < teamsNumber; j++) {
+                std::cout << " " << roundResult.bestResponseValues[j] << " (mixture " << roundResult.mixtureValues[j] << ")";
+            }
+            std::cout << std::endl;
+        }
+        result.rounds.push_back(std::move(roundResult));
+        addProfile(profiles, counts, ages, std::move(bestResponses), round + 1, maxSupportSize);
+    }
+
+    double totalCount = 0;
+    for (auto count: counts) {
+        totalCount += count;
+    }
+    result.profiles = std::move(profiles);
+    for (auto count: counts) {
+        result.weights.push_back(count / totalCount);
+    }
+    return result;
+}
+
+std::vector<double> EquilibriumSolver::probabilitiesOfWin(const std::vector<StrengthVector>& teams,
+                                                          const SimulationOptions& options) {
+    /* Способ оценки -- как у турниров `Simulation` (`options.tournamentBackend`), плотная оценка ведётся в double. */
+    auto backend = Simulation::tournamentBackend(teams, options);
+    if (backend == TournamentBackend::Sparse) {
+        return QualityEstimation::probabilitiesOfWinSparse(teams, options.sparseEpsilon,
+                                                           options.denseStatesLimit).probabilities;
+    }
+    if (backend == TournamentBackend::MonteCarlo) {
+        auto monteCarlo = options.monteCarlo ? options.monteCarlo : std::make_shared<MonteCarloEstimation>();
+        return monteCarlo->probabilitiesOfWin(teams).probabilities;
+    }
+    auto compressedTeams = std::vector<RunLengthTeam>(teams.size());
+    for (int j = 0; j < teams.size(); j++) {
+        compressedTeams[j] = RunLengthTeam(teams[j]);
+    }
+    return QualityEstimation::probabilitiesOfWin(compressedTeams);
+}
+
+void EquilibriumSolver::addProfile(std::vector<std::vector<StrengthVector>>& profiles,
+                                   std::vector<double>& counts,
+                                   std::vector<int>& ages,
+                                   std::vector<StrengthVector> profile,
+                                   const int round,
+                                   const int maxSupportSize) {
+    /* Уже сыгранный профиль (с точностью до порядка гладиаторов в командах) только увеличивает свой вес. */
+    for (int h = 0; h < profiles.size(); h++) {
+        auto isSame = true;
+        for (int j = 0; j < profile.size() && isSame; j++) {
+            isSame = profiles[h][j].canonical().isSame(profile[j].canonical());
+        }
+        if (isSame) {
+            counts[h]++;
+            ages[h] = round;
+            return;
+        }
+    }
+    profiles.push_back(std::move(profile));
+    counts.push_back(1);
+    ages.push_back(round);
+    if (profiles.size() <= maxSupportSize) {
+        return;
+    }
+
+    int removed = 0;
+    for (int h = 1; h < profiles.size(); h++) {
+        if ((counts[h] < counts[removed]) || ((counts[h] == counts[removed]) && (ages[h] < ages[removed]))) {
+            removed = h;
+        }
+    }
+    profiles.erase(profiles.begin() + removed);
+    counts.erase(counts.begin() + removed);
+    ages.erase(ages.begin() + removed);
+}
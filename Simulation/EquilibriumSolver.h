@@ -0,0 +1,47 @@
+#ifndef GLADIATORSIMULATION_EQUILIBRIUMSOLVER_H
+#define GLADIATORSIMULATION_EQUILIBRIUMSOLVER_H
+
+
+#include "Simulation.h"
+
+struct EquilibriumRound {
+    int round{0};
+    // Вероятность победы каждой команды при игре всех по текущей смеси.
+    std::vector<double> mixtureValues;
+    // Вероятность победы найденного наилучшего ответа каждой команды на смесь остальных.
+    std::vector<double> bestResponseValues;
+    // Сумма выигрышей от отклонения: sum_j max(0, bestResponseValues[j] - mixtureValues[j]).
+    double exploitability{0};
+};
+
+struct EquilibriumResult {
+    // Носитель смеси: профили (по команде на участника) и их веса, сумма весов -- 1.
+    std::vector<std::vector<StrengthVector>> profiles;
+    std::vector<double> weights;
+    std::vector<EquilibriumRound> rounds;
+};
+
+class EquilibriumSolver {
+public:
+    static EquilibriumResult solve(const std::vector<double>& totalStrengths,
+                                   const std::vector<int>& gladiatorNumbers,
+                                   int rounds=20,
+                                   int maxSupportSize=8,
+                                   int generationNumber=50,
+                                   int epochs=50,
+                                   double mutationCoefficient=0.5,
+                                   int threadsNumber=3,
+                                   const SimulationOptions& options=SimulationOptions());
+private:
+    static std::vector<double> probabilitiesOfWin(const std::vector<StrengthVector>& teams,
+                                                  const SimulationOptions& options);
+    static void addProfile(std::vector<std::vector<StrengthVector>>& profiles,
+                           std::vector<double>& counts,
+                           std::vector<int>& ages,
+                           std::vector<StrengthVector> profile,
+                           int round,
+                           int maxSupportSize);
+};
+
+
+#endif //GLADIATORSIMULATION_EQUILIBRIUMSOLVER_H
@@ -0,0 +1,189 @@
+#include <iostream>
+#include "Executor.h"
+
+thread_local Executor* Executor::currentExecutor = nullptr;
+thread_local int Executor::currentQueue = -1;
+thread_local bool Executor::isInsideParallelFor = false;
+
+Executor::Executor(const int threadsNumber) {
+    /**
+     * Общий для всех заданий набор потоков со справедливым планированием.
+     *
+     * У каждого задания своя очередь (`openQueue`), свободный поток берёт задачу
+     * из следующей по кругу непустой очереди, поэтому задание с большим числом мелких задач
+     * не задерживает остальные. Поток, ожидающий в `parallelFor`, сам выполняет
+     * задачи своей очереди, а не простаивает.
+     */
+    if (threadsNumber <= 0) {
+        std::cout << "There is wrong number" << threadsNumber << std::endl;
+        exit(-1);
+    }
+    for (int i = 0; i < threadsNumber; i++) {
+        workers.emplace_back(&Executor::work, this);
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    condition.notify_all();
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+Executor& Executor::shared() {
+    static Executor executor(std::max(1, (int) std::thread::hardware_concurrency()));
+    return executor;
+}
+
+int Executor::openQueue() {
+    std::lock_guard<std::mutex> lock(mutex);
+    queues[nextQueueId];
+    return nextQueueId++;
+}
+
+void Executor::closeQueue(const int queue) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = queues.find(queue);
+    if ((it != queues.end()) && it->second.empty()) {
+        queues.erase(it);
+    }
+}
+
+void Executor::parallelFor(const int queue, const int count, const int chunksNumber,
+                           const std::function<void(int)>& body) {
+    auto futures = std::vector<std::future<void>>(chunksNumber);
+    for (int chunk = 0; chunk < chunksNumber; chunk++) {
+        auto begin = (long long) count * chunk / chunksNumber;
+        auto end = (long long) count * (chunk + 1) / chunksNumber;
+        futures[chunk] = submit(queue, [&body, begin, end]() {
+            for (auto i = begin; i < end; i++) {
+                body((int) i);
+            }
+        });
+    }
+
+    /* Исключение части передаётся вызывающему только после завершения всех частей: они ссылаются на `body`. */
+    std::function<void()> task;
+    for (auto& future: futures) {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (popTask(queue, task)) {
+                task();
+            } else {
+                future.wait();
+            }
+        }
+    }
+    for (auto& future: futures) {
+        future.get();
+    }
+}
+
+void Executor::parallelFor(const int count, const int threadsNumber, const std::function<void(int)>& body) {
+    /*
+     * Параллельный цикл из `threadsNumber` частей.
+     *
+     * Если поток привязан к `Executor` (задания `AsyncSimulation`),
+     * части выполняются в очереди задания, иначе -- в отдельных потоках.
+     * Бюджет потоков задаёт внешний цикл: циклы, вложенные в его части
+     * (например, большой поединок внутри отбора), выполняются последовательно.
+     */
+    struct ParallelRegion {
+        bool wasInside{isInsideParallelFor};
+        ParallelRegion() { isInsideParallelFor = true; }
+        ~ParallelRegion() { isInsideParallelFor = wasInside; }
+    };
+    auto runChunk = [&body](const long long begin, const long long end) {
+        auto region = ParallelRegion();
+        for (auto i = begin; i < end; i++) {
+            body((int) i);
+        }
+    };
+
+    auto chunksNumber = std::max(1, std::min(threadsNumber, count));
+    if ((chunksNumber == 1) || isInsideParallelFor) {
+        runChunk(0, count);
+        return;
+    }
+    if (currentExecutor != nullptr) {
+        currentExecutor->parallelFor(currentQueue, chunksNumber, chunksNumber, [&runChunk, count, chunksNumber](const int chunk) {
+            runChunk((long long) count * chunk / chunksNumber, (long long) count * (chunk + 1) / chunksNumber);
+        });
+        return;
+    }
+
+    auto futures = std::vector<std::future<void>>((unsigned long) chunksNumber);
+    for (int chunk = 0; chunk < chunksNumber; chunk++) {
+        auto begin = (long long) count * chunk / chunksNumber;
+        auto end = (long long) count * (chunk + 1) / chunksNumber;
+        futures[chunk] = std::async(std::launch::async, runChunk, begin, end);
+    }
+    for (auto& future: futures) {
+        future.get();
+    }
+}
+
+int Executor::getThreadsNumber() const {
+    return workers.size();
+}
+
+void Executor::bindCurrentThread(Executor* executor, const int queue) {
+    currentExecutor = executor;
+    currentQueue = queue;
+}
+
+Executor* Executor::getCurrentExecutor() {
+    return currentExecutor;
+}
+
+int Executor::getCurrentQueue() {
+    return currentQueue;
+}
+
+bool Executor::popTask(std::function<void()>& task) {
+    /* Вызывается под `mutex`: первая непустая очередь после обслуженной последней. */
+    if (queues.empty()) {
+        return false;
+    }
+    auto it = queues.upper_bound(lastServedQueue);
+    for (size_t checked = 0; checked < queues.size(); checked++, it++) {
+        if (it == queues.end()) {
+            it = queues.begin();
+        }
+        if (!it->second.empty()) {
+            task = std::move(it->second.front());
+            it->second.pop_front();
+            lastServedQueue = it->first;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Executor::popTask(const int queue, std::function<void()>& task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = queues.find(queue);
+    if ((it == queues.end()) || it->second.empty()) {
+        return false;
+    }
+    task = std::move(it->second.front());
+    it->second.pop_front();
+    return true;
+}
+
+void Executor::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this, &task]() { return popTask(task) || isStopping; });
+            if (!task) {
+                return;
+            }
+        }
+        task();
+    }
+}
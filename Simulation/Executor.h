@@ -0,0 +1,68 @@
+#ifndef GLADIATORSIMULATION_EXECUTOR_H
+#define GLADIATORSIMULATION_EXECUTOR_H
+
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Executor {
+public:
+    explicit Executor(int threadsNumber);
+    ~Executor();
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    static Executor& shared();
+
+    int openQueue();
+    void closeQueue(int queue);
+
+    template <typename Task>
+    std::future<std::invoke_result_t<Task>> submit(int queue, Task task) {
+        auto packagedTask = std::make_shared<std::packaged_task<std::invoke_result_t<Task>()>>(std::move(task));
+        auto future = packagedTask->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queues[queue].emplace_back([packagedTask]() { (*packagedTask)(); });
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    void parallelFor(int queue, int count, int chunksNumber, const std::function<void(int)>& body);
+    int getThreadsNumber() const;
+
+    // Параллельный цикл вызывающего потока из `threadsNumber` частей (см. Executor.cpp).
+    static void parallelFor(int count, int threadsNumber, const std::function<void(int)>& body);
+
+    // Очередь, в которую `Simulation` отправляет параллельную работу текущего потока.
+    static void bindCurrentThread(Executor* executor, int queue);
+    static Executor* getCurrentExecutor();
+    static int getCurrentQueue();
+private:
+    std::vector<std::thread> workers;
+    std::map<int, std::deque<std::function<void()>>> queues;
+    int nextQueueId{0};
+    int lastServedQueue{-1};
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool isStopping{false};
+
+    static thread_local Executor* currentExecutor;
+    static thread_local int currentQueue;
+    static thread_local bool isInsideParallelFor;
+
+    bool popTask(std::function<void()>& task);
+    bool popTask(int queue, std::function<void()>& task);
+    void work();
+};
+
+
+#endif //GLADIATORSIMULATION_EXECUTOR_H
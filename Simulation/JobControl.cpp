@@ -0,0 +1,35 @@
+#include "JobControl.h"
+
+JobControl::JobControl(std::function<void(const JobProgress&)> onProgress) {
+    /**
+     * Связь с выполняющимся расчётом: отмена и ход выполнения.
+     *
+     * Расчёт проверяет `isCancelled` после каждой эпохи и при отмене
+     * завершается досрочно, возвращая лучшие на этот момент команды.
+     * После каждой эпохи вызывается `onProgress` (в потоке расчёта).
+     */
+    this->onProgress = std::move(onProgress);
+}
+
+void JobControl::cancel() {
+    cancelled = true;
+}
+
+bool JobControl::isCancelled() const {
+    return cancelled;
+}
+
+void JobControl::reportProgress(const JobProgress& progress) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lastProgress = progress;
+    }
+    if (onProgress) {
+        onProgress(progress);
+    }
+}
+
+JobProgress JobControl::getLastProgress() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastProgress;
+}
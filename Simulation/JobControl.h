@@ -0,0 +1,33 @@
+#ifndef GLADIATORSIMULATION_JOBCONTROL_H
+#define GLADIATORSIMULATION_JOBCONTROL_H
+
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+struct JobProgress {
+    long long epoch{0};
+    long long epochs{0};
+    // Лучшая оценка каждой популяции после отбора.
+    std::vector<double> bestFitness;
+};
+
+class JobControl {
+public:
+    explicit JobControl(std::function<void(const JobProgress&)> onProgress=nullptr);
+
+    void cancel();
+    bool isCancelled() const;
+    void reportProgress(const JobProgress& progress);
+    JobProgress getLastProgress() const;
+private:
+    std::atomic<bool> cancelled{false};
+    std::function<void(const JobProgress&)> onProgress;
+    JobProgress lastProgress;
+    mutable std::mutex mutex;
+};
+
+
+#endif //GLADIATORSIMULATION_JOBCONTROL_H
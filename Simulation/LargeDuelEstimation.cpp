@@ -0,0 +1,130 @@
+#include <cmath>
+#include <limits>
+#include "LargeDuelEstimation.h"
+#include "Executor.h"
+
+double LargeDuelEstimation::logProbabilityOfWinLeftTeam(const StrengthVector& leftTeam,
+                                                        const StrengthVector& rightTeam,
+                                                        const int threadsNumber,
+                                                        const int tileSize) {
+    /**
+     * Логарифм вероятности победы первой команды для очень больших команд.
+     *
+     * Та же рекуррента, что и в `QualityEstimation::probabilityOfWinLeftTeam`:
+     *     p_{j,i} = (b_i / (a_j + b_i)) * p_{j-1,i} + (a_j / (a_j + b_i)) * p_{j,i-1},
+     *     p_{0,i} = 0, p_{j,0} = 1,
+     * но для L_{j,i} := log p_{j,i}, поэтому вероятности порядка 1e-1000 не обращаются в ноль
+     * (см. `processLogTile`). Сетка обходится плитками, как в `forEachTile`.
+     */
+    auto m = leftTeam.getLength();
+    auto n = rightTeam.getLength();
+    auto rowBoundary = std::vector<double>(n, -std::numeric_limits<double>::infinity());
+    auto columnBoundary = std::vector<double>(m, 0.0);
+    forEachTile(m, n, threadsNumber, tileSize, [&](const int leftBegin, const int leftEnd,
+                                                   const int rightBegin, const int rightEnd) {
+        processLogTile(leftTeam.getData(), rightTeam.getData(), rowBoundary.data(), columnBoundary.data(),
+                       leftBegin, leftEnd, rightBegin, rightEnd);
+    });
+    return columnBoundary[m-1];
+}
+
+double LargeDuelEstimation::probabilityOfWinLeftTeam(const StrengthVector& leftTeam,
+                                                     const StrengthVector& rightTeam,
+                                                     const int threadsNumber,
+                                                     const int tileSize) {
+    /**
+     * Вероятность победы первой команды для очень больших команд.
+     *
+     * Рекуррента считается в обычных вероятностях, клетка за клеткой так же, как в
+     * `QualityEstimation::probabilityOfWinLeftTeam`, поэтому результат совпадает с ним до бита,
+     * а вероятности меньше наименьшего double так же обращаются в ноль --
+     * для них есть `logProbabilityOfWinLeftTeam`. Сетка обходится плитками, как в `forEachTile`.
+     */
+    auto m = leftTeam.getLength();
+    auto n = rightTeam.getLength();
+    auto rowBoundary = std::vector<double>(n, 0.0);
+    auto columnBoundary = std::vector<double>(m, 1.0);
+    forEachTile(m, n, threadsNumber, tileSize, [&](const int leftBegin, const int leftEnd,
+                                                   const int rightBegin, const int rightEnd) {
+        processTile(leftTeam.getData(), rightTeam.getData(), rowBoundary.data(), columnBoundary.data(),
+                    leftBegin, leftEnd, rightBegin, rightEnd);
+    });
+    return columnBoundary[m-1];
+}
+
+int LargeDuelEstimation::defaultThreadsNumber() {
+    return std::max(1, (int) std::thread::hardware_concurrency());
+}
+
+void LargeDuelEstimation::forEachTile(const int m, const int n, const int threadsNumber, const int tileSize,
+                                      const std::function<void(int, int, int, int)>& processTile) {
+    /*
+     * Сетка m x n делится на квадратные плитки `tileSize` x `tileSize`.
+     * Плитка (J, I) зависит только от плиток (J-1, I) и (J, I-1), поэтому
+     * плитки одной антидиагонали J + I = d считаются параллельно в `threadsNumber` частях
+     * (`Executor::parallelFor`: внутри чужого параллельного цикла -- последовательно).
+     * Между плитками передаются только границы: `rowBoundary[i]` -- последняя посчитанная
+     * строка столбца i, `columnBoundary[j]` -- последний посчитанный столбец строки j.
+     * Плитки одной антидиагонали пишут в непересекающиеся части границ.
+     */
+    auto leftTiles = (m + tileSize - 1) / tileSize;
+    auto rightTiles = (n + tileSize - 1) / tileSize;
+
+    for (int diagonal = 0; diagonal < leftTiles + rightTiles - 1; diagonal++) {
+        auto firstLeftTile = std::max(0, diagonal - rightTiles + 1);
+        auto tilesNumber = std::min(diagonal, leftTiles - 1) - firstLeftTile + 1;
+        Executor::parallelFor(tilesNumber, threadsNumber, [&, diagonal, firstLeftTile](const int tile) {
+            auto leftTile = firstLeftTile + tile;
+            auto rightTile = diagonal - leftTile;
+            processTile(leftTile * tileSize, std::min(m, (leftTile + 1) * tileSize),
+                        rightTile * tileSize, std::min(n, (rightTile + 1) * tileSize));
+        });
+    }
+}
+
+void LargeDuelEstimation::processTile(const double* leftTeam,
+                                      const double* rightTeam,
+                                      double* rowBoundary,
+                                      double* columnBoundary,
+                                      const int leftBegin, const int leftEnd,
+                                      const int rightBegin, const int rightEnd) {
+    /* Плитка проходится по строкам, строка границы `rowBoundary` остаётся в кэше. */
+    for (int j = leftBegin; j < leftEnd; j++) {
+        auto previous = columnBoundary[j];
+        for (int i = rightBegin; i < rightEnd; i++) {
+            previous = (rightTeam[i] * rowBoundary[i] + leftTeam[j] * previous) / (leftTeam[j] + rightTeam[i]);
+            rowBoundary[i] = previous;
+        }
+        columnBoundary[j] = previous;
+    }
+}
+
+void LargeDuelEstimation::processLogTile(const double* leftTeam,
+                                         const double* rightTeam,
+                                         double* rowBoundary,
+                                         double* columnBoundary,
+                                         const int leftBegin, const int leftEnd,
+                                         const int rightBegin, const int rightEnd) {
+    /*
+     * Если L := max(L_{j-1,i}, L_{j,i-1}), то
+     *     L_{j,i} = L + log(w_u e^{L_{j-1,i} - L} + w_l e^{L_{j,i-1} - L}),
+     * где w_u := b_i / (a_j + b_i), w_l := a_j / (a_j + b_i) считаются без логарифмов,
+     * а одна из экспонент равна 1: на клетку приходятся одна экспонента и один логарифм.
+     */
+    for (int j = leftBegin; j < leftEnd; j++) {
+        auto previous = columnBoundary[j];
+        for (int i = rightBegin; i < rightEnd; i++) {
+            auto sum = leftTeam[j] + rightTeam[i];
+            auto upperWeight = rightTeam[i] / sum;
+            auto leftWeight = leftTeam[j] / sum;
+            auto fromUpper = rowBoundary[i];
+            if (fromUpper > previous) {
+                previous = fromUpper + std::log(upperWeight + leftWeight * std::exp(previous - fromUpper));
+            } else {
+                previous = previous + std::log(leftWeight + upperWeight * std::exp(fromUpper - previous));
+            }
+            rowBoundary[i] = previous;
+        }
+        columnBoundary[j] = previous;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef GLADIATORSIMULATION_LARGEDUELESTIMATION_H
+#define GLADIATORSIMULATION_LARGEDUELESTIMATION_H
+
+
+#include <functional>
+#include "../Gladiator/StrengthVector.h"
+
+class LargeDuelEstimation {
+public:
+    // Начиная с такого числа клеток m*n `QualityEstimation::probabilityOfWinLeftTeam` использует этот класс.
+    static constexpr long long cellsThreshold = 1LL << 22;
+
+    static double logProbabilityOfWinLeftTeam(const StrengthVector& leftTeam,
+                                              const StrengthVector& rightTeam,
+                                              int threadsNumber=defaultThreadsNumber(),
+                                              int tileSize=256);
+    static double probabilityOfWinLeftTeam(const StrengthVector& leftTeam,
+                                           const StrengthVector& rightTeam,
+                                           int threadsNumber=defaultThreadsNumber(),
+                                           int tileSize=256);
+    static int defaultThreadsNumber();
+private:
+    static void forEachTile(int m, int n, int threadsNumber, int tileSize,
+                            const std::function<void(int, int, int, int)>& processTile);
+    static void processTile(const double* leftTeam,
+                            const double* rightTeam,
+                            double* rowBoundary,
+                            double* columnBoundary,
+                            int leftBegin, int leftEnd,
+                            int rightBegin, int rightEnd);
+    static void processLogTile(const double* leftTeam,
+                               const double* rightTeam,
+                               double* rowBoundary,
+                               double* columnBoundary,
+                               int leftBegin, int leftEnd,
+                               int rightBegin, int rightEnd);
+};
+
+
+#endif //GLADIATORSIMULATION_LARGEDUELESTIMATION_H
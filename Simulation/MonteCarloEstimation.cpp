@@ -0,0 +1,142 @@
+#include <bit>
+#include <cmath>
+#include "MonteCarloEstimation.h"
+#include "Executor.h"
+
+void MonteCarloEstimation::checkParameters(const double targetStandardError,
+                                           const long long maxBattles,
+                                           const int threadsNumber) {
+    if ((targetStandardError <= 0) || (maxBattles <= 0) || (threadsNumber <= 0)) {
+        std::cout << "Wrong Monte Carlo parameters: " << targetStandardError << ", "
+                  << maxBattles << ", " << threadsNumber << std::endl;
+        exit(-1);
+    }
+}
+
+MonteCarloEstimation::MonteCarloEstimation(const double targetStandardError,
+                                           const long long maxBattles,
+                                           const int threadsNumber,
+                                           const uint64_t seed) {
+    /**
+     * Оценка вероятностей побед моделированием сражений.
+     *
+     * Сражения идут раундами по `blocksPerRound` блоков из `lanesNumber` сражений,
+     * блоки раунда делятся между `threadsNumber` потоками.
+     * Моделирование останавливается, когда стандартная ошибка каждой вероятности
+     * не больше `targetStandardError` или проведено `maxBattles` сражений.
+     * Случайные числа блока определяются только `seed` и номером блока,
+     * поэтому результат не зависит от числа потоков, а разные команды
+     * оцениваются на одних и тех же случайных числах, что уменьшает шум при их сравнении.
+     */
+    checkParameters(targetStandardError, maxBattles, threadsNumber);
+    this->targetStandardError = targetStandardError;
+    this->maxBattles = maxBattles;
+    this->threadsNumber = threadsNumber;
+    this->seed = seed;
+}
+
+static inline uint64_t mixBits(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static inline double exponentialSample(const uint64_t bits) {
+    /*
+     * -log(u) для u из (0, 1] без ветвлений, чтобы цикл по сражениям векторизовался.
+     * u = 2^e * f, f из [sqrt(2)/2, sqrt(2)), log(f) = 2 atanh(z), z = (f - 1) / (f + 1), |z| < 0.172.
+     */
+    auto u = ((bits >> 11) + 1) * 0x1.0p-53;
+    auto representation = std::bit_cast<uint64_t>(u);
+    auto exponent = (int64_t) ((representation >> 52) & 0x7ff) - 1023;
+    auto fraction = std::bit_cast<double>((representation & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    auto isLarge = fraction > 1.4142135623730951;
+    fraction = isLarge ? fraction * 0.5 : fraction;
+    exponent += isLarge ? 1 : 0;
+
+    auto z = (fraction - 1) / (fraction + 1);
+    auto z2 = z * z;
+    auto series = 1 + z2 * (1.0 / 3 + z2 * (1.0 / 5 + z2 * (1.0 / 7 + z2 * (1.0 / 9 + z2 * (1.0 / 11 + z2 / 13)))));
+    return -(exponent * 0.6931471805599453 + 2 * z * series);
+}
+
+void MonteCarloEstimation::simulateBlock(const std::vector<StrengthVector>& teams,
+                                         const long long block,
+                                         std::vector<long long>& wins) const {
+    /*
+     * Команда j живёт в сумме \sum_i a_j^i X_j^i, где X_j^i ~ Exp(1),
+     * и при последовательных сражениях до смерти побеждает команда,
+     * прожившая дольше всех (для двух команд это P(A_m > B_n) из `probabilityOfWinLeftTeam`).
+     */
+    int teamsNumber = teams.size();
+    double lifetimes[lanesNumber];
+    double bestLifetimes[lanesNumber];
+    int winners[lanesNumber];
+    uint64_t counter = mixBits(seed ^ mixBits((uint64_t) block));
+
+    for (int lane = 0; lane < lanesNumber; lane++) {
+        bestLifetimes[lane] = -1;
+        winners[lane] = 0;
+    }
+
+    for (int j = 0; j < teamsNumber; j++) {
+        for (int lane = 0; lane < lanesNumber; lane++) {
+            lifetimes[lane] = 0;
+        }
+        for (int i = 0; i < teams[j].getLength(); i++) {
+            auto strength = teams[j][i];
+            for (int lane = 0; lane < lanesNumber; lane++) {
+                lifetimes[lane] += strength * exponentialSample(mixBits(counter + lane));
+            }
+            counter += lanesNumber;
+        }
+        for (int lane = 0; lane < lanesNumber; lane++) {
+            auto isBetter = lifetimes[lane] > bestLifetimes[lane];
+            bestLifetimes[lane] = isBetter ? lifetimes[lane] : bestLifetimes[lane];
+            winners[lane] = isBetter ? j : winners[lane];
+        }
+    }
+
+    for (int lane = 0; lane < lanesNumber; lane++) {
+        wins[winners[lane]]++;
+    }
+}
+
+MonteCarloResult MonteCarloEstimation::probabilitiesOfWin(const std::vector<StrengthVector>& teams) const {
+    int teamsNumber = teams.size();
+    auto wins = std::vector<long long>(teamsNumber, 0);
+    auto result = MonteCarloResult{std::vector<double>(teamsNumber, 0.0), 1, 0};
+    long long blocks = 0;
+
+    while ((result.standardError > targetStandardError) && (result.battles < maxBattles)) {
+        auto blockWins = std::vector<std::vector<long long>>(blocksPerRound, std::vector<long long>(teamsNumber, 0));
+        Executor::parallelFor(blocksPerRound, threadsNumber, [this, &teams, &blockWins, blocks](const int block) {
+            simulateBlock(teams, blocks + block, blockWins[block]);
+        });
+        for (auto& roundWins: blockWins) {
+            for (int j = 0; j < teamsNumber; j++) {
+                wins[j] += roundWins[j];
+            }
+        }
+        blocks += blocksPerRound;
+        result.battles = blocks * lanesNumber;
+
+        result.standardError = 0;
+        for (int j = 0; j < teamsNumber; j++) {
+            auto p = (double) wins[j] / result.battles;
+            result.probabilities[j] = p;
+            result.standardError = std::max(result.standardError, std::sqrt(p * (1 - p) / result.battles));
+        }
+        // При p = 0 или 1 оценка ошибки вырождается, поэтому она ограничивается снизу величиной 1/N.
+        result.standardError = std::max(result.standardError, 1.0 / result.battles);
+    }
+
+    return result;
+}
+
+MonteCarloResult MonteCarloEstimation::probabilityOfWinLeftTeam(const StrengthVector& leftTeam,
+                                                                const StrengthVector& rightTeam) const {
+    auto result = probabilitiesOfWin(std::vector<StrengthVector>{leftTeam, rightTeam});
+    result.probabilities.pop_back();
+    return result;
+}
@@ -0,0 +1,39 @@
+#ifndef GLADIATORSIMULATION_MONTECARLOESTIMATION_H
+#define GLADIATORSIMULATION_MONTECARLOESTIMATION_H
+
+
+#include <cstdint>
+#include <future>
+#include "../Gladiator/StrengthVector.h"
+
+struct MonteCarloResult {
+    std::vector<double> probabilities;
+    // Наибольшая по командам стандартная ошибка оценки вероятности.
+    double standardError{0};
+    long long battles{0};
+};
+
+class MonteCarloEstimation {
+public:
+    explicit MonteCarloEstimation(double targetStandardError=1e-3,
+                                  long long maxBattles=1LL << 24,
+                                  int threadsNumber=1,
+                                  uint64_t seed=0x5eed);
+
+    MonteCarloResult probabilityOfWinLeftTeam(const StrengthVector& leftTeam, const StrengthVector& rightTeam) const;
+    MonteCarloResult probabilitiesOfWin(const std::vector<StrengthVector>& teams) const;
+private:
+    static constexpr int lanesNumber = 256;
+    static constexpr int blocksPerRound = 64;
+
+    double targetStandardError;
+    long long maxBattles;
+    int threadsNumber;
+    uint64_t seed;
+
+    void simulateBlock(const std::vector<StrengthVector>& teams, long long block, std::vector<long long>& wins) const;
+    static void checkParameters(double targetStandardError, long long maxBattles, int threadsNumber);
+};
+
+
+#endif //GLADIATORSIMULATION_MONTECARLOESTIMATION_H
@@ -45,6 +45,13 @@ bool MultiIndexGeneric::next() {
     }
 }
 
+void MultiIndexGeneric::setLinearIndex(long long linearIndex) {
+    for (int j = 0; j < dim.size(); j++) {
+        (this->elems)[j] = linearIndex % dim[j];
+        linearIndex /= dim[j];
+    }
+}
+
 std::vector<int>& MultiIndexGeneric::getIndex() {
     return (this->elems);
 }
@@ -15,6 +15,7 @@ public:
     MultiIndexGeneric(std::vector<int> dim);
 
     bool next();
+    void setLinearIndex(long long linearIndex);
     std::vector<int>& getIndex();
 private:
     std::vector<int> dim{0};
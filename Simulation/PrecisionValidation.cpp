@@ -0,0 +1,66 @@
+#include <cmath>
+#include <iostream>
+#include "PrecisionValidation.h"
+#include "SurrogateEstimation.h"
+
+PrecisionValidation::PrecisionValidation(const int auditPeriod) {
+    /**
+     * Контроль расхождения отбора в одинарной точности с отбором в double.
+     *
+     * Каждый `auditPeriod`-й отбор (0 -- никогда) оценки тех же команд
+     * пересчитываются в double, и запоминаются наибольшая абсолютная погрешность,
+     * корреляция рангов Спирмена и число случаев, когда лучшая в double команда
+     * не совпала с лучшей по быстрой оценке.
+     */
+    this->auditPeriod = auditPeriod;
+}
+
+bool PrecisionValidation::nextAudit() {
+    selectionsNumber++;
+    return (auditPeriod > 0) && (selectionsNumber % auditPeriod == 0);
+}
+
+void PrecisionValidation::report(const std::vector<double>& fastScores, const std::vector<double>& exactScores) {
+    if (fastScores.empty()) {
+        return;
+    }
+    int bestFast = 0;
+    int bestExact = 0;
+    for (int i = 0; i < fastScores.size(); i++) {
+        maxAbsoluteError = std::max(maxAbsoluteError, std::abs(fastScores[i] - exactScores[i]));
+        bestFast = (fastScores[i] > fastScores[bestFast]) ? i : bestFast;
+        bestExact = (exactScores[i] > exactScores[bestExact]) ? i : bestExact;
+    }
+    lastRankCorrelation = SurrogateEstimation::rankCorrelation(fastScores, exactScores);
+    minRankCorrelation = std::min(minRankCorrelation, lastRankCorrelation);
+    leaderChanges += (exactScores[bestFast] < exactScores[bestExact]) ? 1 : 0;
+    auditsNumber++;
+}
+
+int PrecisionValidation::getAuditsNumber() const {
+    return auditsNumber;
+}
+
+double PrecisionValidation::getMaxAbsoluteError() const {
+    return maxAbsoluteError;
+}
+
+double PrecisionValidation::getLastRankCorrelation() const {
+    return lastRankCorrelation;
+}
+
+double PrecisionValidation::getMinRankCorrelation() const {
+    return minRankCorrelation;
+}
+
+int PrecisionValidation::getLeaderChanges() const {
+    return leaderChanges;
+}
+
+void PrecisionValidation::printStatistics() const {
+    std::cout << "Float selection: " << auditsNumber << " audits"
+              << ", max absolute error " << maxAbsoluteError
+              << ", last rank correlation " << lastRankCorrelation
+              << ", min rank correlation " << minRankCorrelation
+              << ", leader changes " << leaderChanges << std::endl;
+}
@@ -0,0 +1,31 @@
+#ifndef GLADIATORSIMULATION_PRECISIONVALIDATION_H
+#define GLADIATORSIMULATION_PRECISIONVALIDATION_H
+
+
+#include <vector>
+
+class PrecisionValidation {
+public:
+    explicit PrecisionValidation(int auditPeriod=10);
+
+    bool nextAudit();
+    void report(const std::vector<double>& fastScores, const std::vector<double>& exactScores);
+
+    int getAuditsNumber() const;
+    double getMaxAbsoluteError() const;
+    double getLastRankCorrelation() const;
+    double getMinRankCorrelation() const;
+    int getLeaderChanges() const;
+    void printStatistics() const;
+private:
+    int auditPeriod;
+    int selectionsNumber{0};
+    int auditsNumber{0};
+    double maxAbsoluteError{0};
+    double lastRankCorrelation{1};
+    double minRankCorrelation{1};
+    int leaderChanges{0};
+};
+
+
+#endif //GLADIATORSIMULATION_PRECISIONVALIDATION_H
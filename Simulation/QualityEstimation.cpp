@@ -2,9 +2,16 @@
 // Created by xapulc on 14.11.2020.
 //
 
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
 #include "QualityEstimation.h"
+#include "LargeDuelEstimation.h"
+#include "Executor.h"
 
-double QualityEstimation::probabilityOfWinLeftTeam(const StrengthVector &leftTeam, const StrengthVector &rightTeam) {
+template <typename Scalar>
+Scalar QualityEstimation::probabilityOfWinLeftTeam(const BasicStrengthVector<Scalar> &leftTeam,
+                                                   const BasicStrengthVector<Scalar> &rightTeam) {
     /**
      * Вероятность выживания фиксированного количества гладиаторов у каждой команды.
      *
@@ -35,10 +42,32 @@ double QualityEstimation::probabilityOfWinLeftTeam(const StrengthVector &leftTea
      * Первый будет нужен для нахождения вероятностей вида (1) при k = m,
      * второй по правилу (2) и начальным состоянием p_{j,0} = 1, p_{0,i} = 0
      * позволяет вычислить все элементы вида p_{j,n}.
+     *
+     * Вычисления ведутся в типе `Scalar`: float вдвое уменьшает объём данных
+     * и подходит для ранжирования, итоговые вероятности считаются в double.
+     *
+     * Начиная с `LargeDuelEstimation::cellsThreshold` клеток сетки считается
+     * параллельно по плиткам `LargeDuelEstimation::probabilityOfWinLeftTeam` с тем же результатом.
      */
-    auto m = leftTeam.getLength();
-    auto n = rightTeam.getLength();
-    std::vector<double> curWinLeft(m);
+    return probabilityOfWinLeftTeam(leftTeam.getData(), leftTeam.getLength(),
+                                    rightTeam.getData(), rightTeam.getLength());
+}
+
+template <typename Scalar>
+Scalar QualityEstimation::probabilityOfWinLeftTeam(const Scalar* leftTeam, const int m,
+                                                   const Scalar* rightTeam, const int n) {
+    if ((long long) m * n >= LargeDuelEstimation::cellsThreshold) {
+        auto left = StrengthVector(m);
+        auto right = StrengthVector(n);
+        for (int j = 0; j < m; j++) {
+            left[j] = leftTeam[j];
+        }
+        for (int i = 0; i < n; i++) {
+            right[i] = rightTeam[i];
+        }
+        return (Scalar) LargeDuelEstimation::probabilityOfWinLeftTeam(left, right);
+    }
+    std::vector<Scalar> curWinLeft(m);
     std::fill(curWinLeft.begin(), curWinLeft.end(), 1.0);
 
     for (int i = 0; i < n; i++) {
@@ -52,6 +81,327 @@ double QualityEstimation::probabilityOfWinLeftTeam(const StrengthVector &leftTea
     return curWinLeft[m-1];
 }
 
+template <typename Scalar>
+Scalar QualityEstimation::probabilityOfWinLeftTeam(const BasicStrengthVector<Scalar>& leftTeam,
+                                                   const PreparedOpponent& rightTeam) {
+    /* Противник из серий одинаковых гладиаторов считается по сериям, иначе -- из подготовленного массива. */
+    if (rightTeam.isCompressed()) {
+        return probabilityOfWinLeftTeam(leftTeam, rightTeam.getRuns());
+    }
+    if constexpr (std::is_same_v<Scalar, float>) {
+        return probabilityOfWinLeftTeam(leftTeam.getData(), leftTeam.getLength(),
+                                        rightTeam.getFloatStrengths(), rightTeam.getLength());
+    } else {
+        return probabilityOfWinLeftTeam(leftTeam.getData(), leftTeam.getLength(),
+                                        rightTeam.getStrengths(), rightTeam.getLength());
+    }
+}
+
+template <typename Scalar>
+std::vector<double> QualityEstimation::probabilitiesOfWinAgainstEnsemble(const BasicStrengthVector<Scalar>& leftTeam,
+                                                                        const EnemyEnsemble& enemies) {
+    /**
+     * Вероятности победы одной команды над каждым противником набора `enemies`.
+     *
+     * Силы команды копируются один раз в локальный массив, вектор `curWinLeft`
+     * переиспользуется для всех противников, а силы противников читаются
+     * подряд из упакованного массива набора.
+     * Результат перечислен в порядке упаковки противников (см. `EnemyEnsemble::getOriginalIndex`).
+     */
+    auto m = leftTeam.getLength();
+    auto left = std::vector<Scalar>(m);
+    for (int j = 0; j < m; j++) {
+        left[j] = leftTeam[j];
+    }
+    std::vector<Scalar> curWinLeft(m);
+    auto result = std::vector<double>(enemies.getEnemiesNumber());
+
+    for (int enemy = 0; enemy < enemies.getEnemiesNumber(); enemy++) {
+        auto right = enemies.getStrengths(enemy);
+        auto n = enemies.getLength(enemy);
+        std::fill(curWinLeft.begin(), curWinLeft.end(), 1.0);
+
+        for (int i = 0; i < n; i++) {
+            auto rightStrength = (Scalar) right[i];
+            auto previous = left[0] * curWinLeft[0] / (left[0] + rightStrength);
+            curWinLeft[0] = previous;
+            for (int j = 1; j < m; j++) {
+                previous = (rightStrength * previous + left[j] * curWinLeft[j]) / (left[j] + rightStrength);
+                curWinLeft[j] = previous;
+            }
+        }
+        result[enemy] = curWinLeft[m-1];
+    }
+    return result;
+}
+
+std::vector<double> QualityEstimation::probabilitiesOfWinLeftTeam(const std::vector<StrengthVector>& leftTeams,
+                                                                 const std::vector<StrengthVector>& rightTeams,
+                                                                 const int threadsNumber) {
+    /**
+     * Вероятности победы `leftTeams[d]` над `rightTeams[d]` для пакета поединков.
+     *
+     * Поединки упорядочиваются по размерам (m, n), и поединки одинакового размера
+     * считаются блоками по `batchLanes`: в рекурренте (2) самый внутренний цикл
+     * идёт по поединкам блока, поэтому вместо одной последовательной цепочки
+     * получаются независимые вычисления, которые компилятор векторизует.
+     * Блоки делятся между `threadsNumber` потоками.
+     */
+    int duelsNumber = leftTeams.size();
+    auto result = std::vector<double>(duelsNumber);
+    auto order = std::vector<int>(duelsNumber);
+    for (int d = 0; d < duelsNumber; d++) {
+        order[d] = d;
+    }
+    std::sort(order.begin(), order.end(), [&leftTeams, &rightTeams](const int first, const int second) {
+        return std::make_pair(leftTeams[first].getLength(), rightTeams[first].getLength())
+               < std::make_pair(leftTeams[second].getLength(), rightTeams[second].getLength());
+    });
+
+    auto blocks = std::vector<std::pair<int, int>>();
+    for (int begin = 0; begin < duelsNumber;) {
+        auto end = begin + 1;
+        while ((end < duelsNumber) && (end - begin < batchLanes)
+               && (leftTeams[order[end]].getLength() == leftTeams[order[begin]].getLength())
+               && (rightTeams[order[end]].getLength() == rightTeams[order[begin]].getLength())) {
+            end++;
+        }
+        blocks.emplace_back(begin, end - begin);
+        begin = end;
+    }
+
+    int blocksNumber = blocks.size();
+    Executor::parallelFor(blocksNumber, threadsNumber, [&](const int block) {
+        auto [first, lanes] = blocks[block];
+        auto duel = order[first];
+        if ((lanes == 1) || ((long long) leftTeams[duel].getLength() * rightTeams[duel].getLength()
+                             >= LargeDuelEstimation::cellsThreshold)) {
+            for (int lane = 0; lane < lanes; lane++) {
+                duel = order[first + lane];
+                result[duel] = probabilityOfWinLeftTeam(leftTeams[duel], rightTeams[duel]);
+            }
+        } else {
+            const double* left[batchLanes];
+            const double* right[batchLanes];
+            double probabilities[batchLanes];
+            for (int lane = 0; lane < lanes; lane++) {
+                left[lane] = leftTeams[order[first + lane]].getData();
+                right[lane] = rightTeams[order[first + lane]].getData();
+            }
+            probabilitiesOfWinLeftTeamLanes(left, right, false, leftTeams[duel].getLength(),
+                                            rightTeams[duel].getLength(), lanes, probabilities);
+            for (int lane = 0; lane < lanes; lane++) {
+                result[order[first + lane]] = probabilities[lane];
+            }
+        }
+    });
+    return result;
+}
+
+void QualityEstimation::probabilitiesOfWinLeftTeam(const double* leftTeams,
+                                                   const int leftLength,
+                                                   const long long leftStride,
+                                                   const double* rightTeams,
+                                                   const int rightLength,
+                                                   const long long rightStride,
+                                                   const long long duelsNumber,
+                                                   double* result,
+                                                   const int threadsNumber) {
+    /**
+     * Пакет поединков одинакового размера над массивами вызывающей стороны, без копирования команд.
+     *
+     * Команды поединка `d` начинаются с `leftTeams + d * leftStride` и `rightTeams + d * rightStride`
+     * (нулевой шаг -- один противник для всех поединков, его силы читаются прямо из `rightTeams`),
+     * вероятность победы левой команды записывается в `result[d]`.
+     * Подряд идущие поединки считаются блоками по `batchLanes`.
+     */
+    auto blocksNumber = (int) ((duelsNumber + batchLanes - 1) / batchLanes);
+    auto isLarge = (long long) leftLength * rightLength >= LargeDuelEstimation::cellsThreshold;
+    auto isSharedRight = (rightStride == 0);
+    Executor::parallelFor(blocksNumber, threadsNumber, [&](const int block) {
+        auto first = (long long) block * batchLanes;
+        auto lanes = (int) std::min<long long>(batchLanes, duelsNumber - first);
+        if ((lanes == 1) || isLarge) {
+            for (auto duel = first; duel < first + lanes; duel++) {
+                result[duel] = probabilityOfWinLeftTeam(leftTeams + duel * leftStride, leftLength,
+                                                        rightTeams + duel * rightStride, rightLength);
+            }
+            return;
+        }
+        const double* left[batchLanes];
+        const double* right[batchLanes];
+        for (int lane = 0; lane < lanes; lane++) {
+            left[lane] = leftTeams + (first + lane) * leftStride;
+            right[lane] = rightTeams + (first + lane) * rightStride;
+        }
+        probabilitiesOfWinLeftTeamLanes(left, right, isSharedRight, leftLength, rightLength, lanes, result + first);
+    });
+}
+
+void QualityEstimation::probabilitiesOfWinLeftTeam(const StrengthVector* leftTeams,
+                                                   const int teamsNumber,
+                                                   const PreparedOpponent& rightTeam,
+                                                   double* result) {
+    /**
+     * Вероятности победы `teamsNumber` команд подряд с `leftTeams` над одним подготовленным противником.
+     *
+     * Соседние команды одинаковой длины считаются блоками по `batchLanes`;
+     * сила противника в каждом столбце одна на весь блок и читается из `PreparedOpponent::getStrengths`
+     * (больше ничего в рекурренте (2) от столбца не зависит: знаменатель a_j + b_i свой у каждой клетки).
+     * Противник из серий и очень большие поединки считаются по одному.
+     */
+    auto n = rightTeam.getLength();
+    for (int first = 0; first < teamsNumber;) {
+        auto m = leftTeams[first].getLength();
+        auto lanes = 1;
+        while ((first + lanes < teamsNumber) && (lanes < batchLanes) && (leftTeams[first + lanes].getLength() == m)) {
+            lanes++;
+        }
+        if ((lanes == 1) || rightTeam.isCompressed() || ((long long) m * n >= LargeDuelEstimation::cellsThreshold)) {
+            for (int team = first; team < first + lanes; team++) {
+                result[team] = probabilityOfWinLeftTeam(leftTeams[team], rightTeam);
+            }
+        } else {
+            const double* left[batchLanes];
+            const double* right[] = {rightTeam.getStrengths()};
+            for (int lane = 0; lane < lanes; lane++) {
+                left[lane] = leftTeams[first + lane].getData();
+            }
+            probabilitiesOfWinLeftTeamLanes(left, right, true, m, n, lanes, result + first);
+        }
+        first += lanes;
+    }
+}
+
+void QualityEstimation::probabilitiesOfWinLeftTeamLanes(const double* const* leftTeams,
+                                                        const double* const* rightTeams,
+                                                        const bool isSharedRight,
+                                                        const int m,
+                                                        const int n,
+                                                        const int lanes,
+                                                        double* result) {
+    /*
+     * Массивы хранятся как [индекс гладиатора][поединок блока], неиспользуемые поединки -- копии последнего.
+     * При `isSharedRight` противник один -- `rightTeams[0]` -- и не копируется.
+     * Буферы свои у каждого потока и переиспользуются между блоками.
+     */
+    static thread_local std::vector<double> left;
+    static thread_local std::vector<double> right;
+    left.resize(m * batchLanes);
+    for (int lane = 0; lane < batchLanes; lane++) {
+        auto duel = std::min(lane, lanes - 1);
+        for (int j = 0; j < m; j++) {
+            left[j * batchLanes + lane] = leftTeams[duel][j];
+        }
+    }
+    if (isSharedRight) {
+        advanceLanes(left.data(), rightTeams[0], true, m, n, lanes, result);
+        return;
+    }
+    right.resize(n * batchLanes);
+    for (int lane = 0; lane < batchLanes; lane++) {
+        auto duel = std::min(lane, lanes - 1);
+        for (int i = 0; i < n; i++) {
+            right[i * batchLanes + lane] = rightTeams[duel][i];
+        }
+    }
+    advanceLanes(left.data(), right.data(), false, m, n, lanes, result);
+}
+
+void QualityEstimation::advanceLanes(const double* left,
+                                     const double* right,
+                                     const bool isSharedRight,
+                                     const int m,
+                                     const int n,
+                                     const int lanes,
+                                     double* result) {
+    /*
+     * Рекуррента (2) для блока из `batchLanes` поединков, результат первых `lanes` -- в `result`.
+     * Противники хранятся как [индекс гладиатора][поединок блока], а при `isSharedRight`
+     * противник у всех поединков один, и его сила в столбце `i` -- right[i].
+     */
+    static thread_local std::vector<double> curWinLeft;
+    curWinLeft.assign(m * batchLanes, 1.0);
+    double rightStrength[batchLanes];
+
+    for (int i = 0; i < n; i++) {
+        for (int lane = 0; lane < batchLanes; lane++) {
+            rightStrength[lane] = isSharedRight ? right[i] : right[i * batchLanes + lane];
+        }
+        for (int lane = 0; lane < batchLanes; lane++) {
+            curWinLeft[lane] = left[lane] * curWinLeft[lane] / (left[lane] + rightStrength[lane]);
+        }
+        for (int j = 1; j < m; j++) {
+            auto previous = &curWinLeft[(j - 1) * batchLanes];
+            auto current = &curWinLeft[j * batchLanes];
+            auto leftStrength = &left[j * batchLanes];
+            for (int lane = 0; lane < batchLanes; lane++) {
+                current[lane] = (rightStrength[lane] * previous[lane] + leftStrength[lane] * current[lane])
+                                / (leftStrength[lane] + rightStrength[lane]);
+            }
+        }
+    }
+
+    for (int lane = 0; lane < lanes; lane++) {
+        result[lane] = curWinLeft[(m - 1) * batchLanes + lane];
+    }
+}
+
+std::vector<double> QualityEstimation::survivalProbabilities(const StrengthVector& leftTeam,
+                                                            const StrengthVector& rightTeam) {
+    /**
+     * Распределение числа выживших гладиаторов обеих команд за один проход.
+     *
+     * Возвращается вектор длины m + n, описанный в `probabilityOfWinLeftTeam`:
+     * сначала вероятности того, что выживет ровно `k` гладиаторов первой команды (1 <= k <= m),
+     * затем вероятности того, что выживет ровно `l` гладиаторов второй команды (1 <= l <= n).
+     *
+     * После прохода по всем столбцам `curWinLeft` = (p_{1,n}, ..., p_{m,n}), поэтому
+     *     P(выживет ровно k у первой) = p_{m-k+1,n} - p_{m-k,n}, p_{0,n} = 0,
+     * а вектор `winLeftWithFullTeam` = (p_{m,1}, ..., p_{m,n}) заполняется по ходу прохода, и
+     *     P(выживет ровно l у второй) = p_{m,n-l} - p_{m,n-l+1}, p_{m,0} = 1.
+     * Время O(m n), дополнительная память O(m + n).
+     */
+    auto m = leftTeam.getLength();
+    auto n = rightTeam.getLength();
+    std::vector<double> curWinLeft(m);
+    std::vector<double> winLeftWithFullTeam(n);
+    std::fill(curWinLeft.begin(), curWinLeft.end(), 1.0);
+
+    for (int i = 0; i < n; i++) {
+        advanceColumn(curWinLeft, leftTeam, rightTeam[i]);
+        winLeftWithFullTeam[i] = curWinLeft[m-1];
+    }
+
+    auto result = std::vector<double>(m + n);
+    for (int k = 1; k <= m; k++) {
+        result[k-1] = curWinLeft[m-k] - ((m - k > 0) ? curWinLeft[m-k-1] : 0);
+    }
+    for (int l = 1; l <= n; l++) {
+        result[m+l-1] = ((n - l > 0) ? winLeftWithFullTeam[n-l-1] : 1) - winLeftWithFullTeam[n-l];
+    }
+    return result;
+}
+
+std::vector<std::vector<double>> QualityEstimation::survivalProbabilities(const std::vector<StrengthVector>& leftTeams,
+                                                                         const StrengthVector& rightTeam,
+                                                                         const int threadsNumber) {
+    auto result = std::vector<std::vector<double>>(leftTeams.size());
+    Executor::parallelFor(leftTeams.size(), threadsNumber, [&result, &leftTeams, &rightTeam](const int i) {
+        result[i] = survivalProbabilities(leftTeams[i], rightTeam);
+    });
+    return result;
+}
+
+double QualityEstimation::expectedSurvivorsLeftTeam(const std::vector<double>& survivalProbabilities,
+                                                    const int leftLength) {
+    double result = 0;
+    for (int k = 1; k <= leftLength; k++) {
+        result += k * survivalProbabilities[k-1];
+    }
+    return result;
+}
+
 std::vector<double> QualityEstimation::probabilitiesOfWin(const std::vector<StrengthVector> &teams) {
     /*
      * Вектор вероятностей побед каждой команды.
@@ -132,3 +482,354 @@ std::vector<double> QualityEstimation::probabilitiesOfWin(const std::vector<Stre
         }
     }
 }
+
+template <typename Scalar>
+void QualityEstimation::advanceColumn(std::vector<Scalar>& curWinLeft,
+                                      const BasicStrengthVector<Scalar>& leftTeam,
+                                      const Scalar rightStrength) {
+    auto m = leftTeam.getLength();
+    curWinLeft[0] = leftTeam[0] * curWinLeft[0] / (leftTeam[0] + rightStrength);
+    for (int j = 1; j < m; j++) {
+        curWinLeft[j] = (rightStrength * curWinLeft[j-1] + leftTeam[j] * curWinLeft[j])
+                        / (leftTeam[j] + rightStrength);
+    }
+}
+
+template <typename Scalar>
+void QualityEstimation::advanceRun(std::vector<Scalar>& curWinLeft,
+                                   const BasicStrengthVector<Scalar>& leftTeam,
+                                   const Scalar rightStrength,
+                                   const int count) {
+    /**
+     * Переход через серию из `count` одинаковых гладиаторов силы b второй команды.
+     *
+     * Один столбец рекурренты (2) -- линейное отображение p_{.,i} = M p_{.,i-1}
+     * с нижнетреугольной матрицей M_{j,l} = r_l \prod_{q=l+1}^j s_q,
+     * где r_j := a_j / (a_j + b), s_j := b / (a_j + b).
+     * Для серии достаточно применить M^count, что при большом `count`
+     * дешевле делать возведением в степень: коэффициенты M^count --
+     * это вероятности отрицательно-биномиального числа побед гладиаторов первой команды.
+     * Возведение стоит O(m^3 log(count)), пошаговый проход -- O(m count),
+     * выбирается более дешёвый вариант, так что серия стоит O(m min(count, m^2 log(count))),
+     * а не O(m): при count = 100 возведение выгоднее только при m < 7.
+     * Замкнутая формула для M^count через разделённые разности по r_j дала бы O(m^2) на серию,
+     * но она делит на r_l - r_j и теряет точность при равных и близких силах a_j,
+     * обычных для команд, поэтому не используется.
+     */
+    auto m = leftTeam.getLength();
+    int bits = 0;
+    for (int c = count; c > 0; c >>= 1) {
+        bits++;
+    }
+
+    if ((long long) m * m * bits >= 3LL * count) {
+        for (int i = 0; i < count; i++) {
+            advanceColumn(curWinLeft, leftTeam, rightStrength);
+        }
+        return;
+    }
+
+    auto power = std::vector<Scalar>(m * m, 0);
+    for (int l = 0; l < m; l++) {
+        Scalar product = leftTeam[l] / (leftTeam[l] + rightStrength);
+        power[l * m + l] = product;
+        for (int j = l + 1; j < m; j++) {
+            product *= rightStrength / (leftTeam[j] + rightStrength);
+            power[j * m + l] = product;
+        }
+    }
+
+    auto buffer = std::vector<Scalar>(m * m);
+    auto vector = std::vector<Scalar>(m);
+    for (int exponent = count; exponent > 0; exponent >>= 1) {
+        if (exponent & 1) {
+            for (int j = 0; j < m; j++) {
+                Scalar value = 0;
+                for (int l = 0; l <= j; l++) {
+                    value += power[j * m + l] * curWinLeft[l];
+                }
+                vector[j] = value;
+            }
+            std::swap(curWinLeft, vector);
+        }
+
+        if (exponent > 1) {
+            for (int j = 0; j < m; j++) {
+                for (int l = 0; l <= j; l++) {
+                    Scalar value = 0;
+                    for (int q = l; q <= j; q++) {
+                        value += power[j * m + q] * power[q * m + l];
+                    }
+                    buffer[j * m + l] = value;
+                }
+            }
+            std::swap(power, buffer);
+        }
+    }
+}
+
+template <typename Scalar>
+Scalar QualityEstimation::probabilityOfWinLeftTeam(const BasicStrengthVector<Scalar>& leftTeam,
+                                                   const RunLengthTeam& rightTeam) {
+    /**
+     * Вероятность победы первой команды над командой, заданной сериями одинаковых гладиаторов.
+     *
+     * Совпадает с `probabilityOfWinLeftTeam(leftTeam, rightTeam.expand())`,
+     * но каждая серия проходится за один шаг `advanceRun`.
+     */
+    auto m = leftTeam.getLength();
+    std::vector<Scalar> curWinLeft(m);
+    std::fill(curWinLeft.begin(), curWinLeft.end(), 1);
+
+    for (int run = 0; run < rightTeam.getRunsNumber(); run++) {
+        advanceRun(curWinLeft, leftTeam, (Scalar) rightTeam.getStrength(run), rightTeam.getCount(run));
+    }
+
+    return curWinLeft[m-1];
+}
+
+template <typename Scalar>
+std::vector<double> QualityEstimation::probabilitiesOfWin(const std::vector<RunLengthTeam>& teams) {
+    /*
+     * Вектор вероятностей побед каждой команды для команд, заданных сериями.
+     *
+     * Рекуррента та же, что и в `probabilitiesOfWin` для `StrengthVector`.
+     * Число состояний сократить нельзя (важно, сколько гладиаторов серии ещё живы),
+     * но обратные силы вычисляются один раз на серию, знаменатель -- один раз на состояние,
+     * а таблица хранится плоским массивом с шагами по каждой команде,
+     * так что переход к состоянию k - e_l -- это сдвиг индекса на `strides[l]`.
+     * Таблица хранится в типе `Scalar`, для float она вдвое меньше.
+     */
+    int teamsNumber = teams.size();
+    auto strides = std::vector<long long>(teamsNumber);
+    auto inverseStrengths = std::vector<std::vector<Scalar>>(teamsNumber);
+    long long statesNumber = 1;
+
+    for (int l = 0; l < teamsNumber; l++) {
+        strides[l] = statesNumber;
+        statesNumber *= teams[l].getLength() + 1;
+        for (int run = 0; run < teams[l].getRunsNumber(); run++) {
+            auto inverseStrength = (Scalar) (1 / teams[l].getStrength(run));
+            inverseStrengths[l].insert(inverseStrengths[l].end(), teams[l].getCount(run), inverseStrength);
+        }
+    }
+
+    auto probabilityMatrix = std::vector<Scalar>(statesNumber * teamsNumber);
+    auto k = std::vector<int>(teamsNumber, 0);
+    for (int j = 0; j < teamsNumber; j++) {
+        probabilityMatrix[j] = 1;
+    }
+
+    for (long long state = 1; state < statesNumber; state++) {
+        for (int l = 0; (l < teamsNumber) && (++k[l] > teams[l].getLength()); l++) {
+            k[l] = 0;
+        }
+
+        Scalar denominator = 0;
+        for (int l = 0; l < teamsNumber; l++) {
+            if (k[l] != 0) {
+                denominator += inverseStrengths[l][k[l]-1];
+            }
+        }
+
+        auto current = &probabilityMatrix[state * teamsNumber];
+        for (int j = 0; j < teamsNumber; j++) {
+            current[j] = 0;
+        }
+        for (int l = 0; l < teamsNumber; l++) {
+            if (k[l] != 0) {
+                auto weight = inverseStrengths[l][k[l]-1] / denominator;
+                auto loser = &probabilityMatrix[(state - strides[l]) * teamsNumber];
+                for (int j = 0; j < teamsNumber; j++) {
+                    current[j] += loser[j] * weight;
+                }
+            }
+        }
+        for (int j = 0; j < teamsNumber; j++) {
+            if (k[j] == 0) {
+                current[j] = 0;
+            }
+        }
+    }
+
+    return std::vector<double>(probabilityMatrix.end() - teamsNumber, probabilityMatrix.end());
+}
+
+SparseProbabilities QualityEstimation::probabilitiesOfWinSparse(const std::vector<StrengthVector>& teams,
+                                                                const double epsilon,
+                                                                const long long maxFrontierSize) {
+    /*
+     * Приближённый вектор вероятностей побед с отбрасыванием малых состояний.
+     *
+     * Та же цепь, что и в `probabilitiesOfWin`, проходится вперёд:
+     * из состояния k (числа живых гладиаторов команд) с вероятностью
+     *     (1/a_l^{k_l}) / (1/a_1^{k_1} + ... + 1/a_n^{k_n})
+     * погибает гладиатор команды `l`, и цепь переходит в k - e_l.
+     * Когда жива только одна команда, её масса прибавляется к её вероятности победы.
+     *
+     * С каждым шагом суммарное число живых гладиаторов уменьшается на 1,
+     * поэтому достаточно хранить только текущий фронт в хэш-таблице.
+     * Состояния фронта с массой меньше `epsilon` отбрасываются,
+     * а их суммарная масса возвращается как оценка погрешности.
+     * Масса всего фронта не больше 1, поэтому при `epsilon` > 0 в нём не больше 1/`epsilon` состояний.
+     * Если задан `maxFrontierSize` (0 -- без ограничения), во фронте остаются
+     * не больше `maxFrontierSize` состояний с наибольшей массой, остальные тоже отбрасываются.
+     * При `epsilon` = 0 и не достигнутом ограничении фронта результат совпадает с точным.
+     *
+     * Состояние кодируется числом в смешанной системе счисления с основаниями m_l + 1,
+     * 64-битным, если все состояния в него помещаются, иначе 128-битным.
+     */
+    if (!isSparseRepresentable(teams)) {
+        std::cout << "Too many states for sparse estimation" << std::endl;
+        exit(-1);
+    }
+    int teamsNumber = teams.size();
+    auto result = SparseProbabilities{std::vector<double>(teamsNumber, 0.0), 0, 0};
+    auto inverseStrengths = std::vector<std::vector<double>>(teamsNumber);
+    for (int l = 0; l < teamsNumber; l++) {
+        inverseStrengths[l] = std::vector<double>(teams[l].getLength());
+        for (int i = 0; i < teams[l].getLength(); i++) {
+            inverseStrengths[l][i] = 1 / teams[l][i];
+        }
+    }
+
+    if (statesNumber(teams) < std::numeric_limits<long long>::max()) {
+        propagateSparse<uint64_t>(inverseStrengths, epsilon, maxFrontierSize, result);
+    } else {
+        propagateSparse<unsigned __int128>(inverseStrengths, epsilon, maxFrontierSize, result);
+    }
+    return result;
+}
+
+bool QualityEstimation::isSparseRepresentable(const std::vector<StrengthVector>& teams) {
+    /* Помещается ли номер любого состояния \prod (m_l + 1) в 128 бит. */
+    unsigned __int128 states = 1;
+    auto maxStates = ~(unsigned __int128) 0;
+    for (auto& team: teams) {
+        if (states > maxStates / (unsigned) (team.getLength() + 1)) {
+            return false;
+        }
+        states *= (unsigned) (team.getLength() + 1);
+    }
+    return true;
+}
+
+template <typename Key>
+void QualityEstimation::propagateSparse(const std::vector<std::vector<double>>& inverseStrengths,
+                                        const double epsilon,
+                                        const long long maxFrontierSize,
+                                        SparseProbabilities& result) {
+    struct KeyHash {
+        size_t operator()(const Key key) const {
+            auto low = (uint64_t) key;
+            auto high = (uint64_t) (key >> 32 >> 32);
+            return std::hash<uint64_t>()(low ^ (high * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+    int teamsNumber = inverseStrengths.size();
+    auto dimensions = std::vector<Key>(teamsNumber);
+    auto strides = std::vector<Key>(teamsNumber);
+    auto k = std::vector<int>(teamsNumber);
+    Key stride = 1;
+    Key initialState = 0;
+    for (int l = 0; l < teamsNumber; l++) {
+        dimensions[l] = inverseStrengths[l].size() + 1;
+        strides[l] = stride;
+        initialState += stride * (Key) inverseStrengths[l].size();
+        stride *= dimensions[l];
+    }
+
+    std::unordered_map<Key, double, KeyHash> frontier, nextFrontier;
+    frontier[initialState] = 1;
+
+    while (!frontier.empty()) {
+        nextFrontier.clear();
+        nextFrontier.reserve(frontier.size() * teamsNumber);
+        for (auto& [state, mass] : frontier) {
+            auto rest = state;
+            int aliveTeams = 0;
+            int lastAliveTeam = 0;
+            double denominator = 0;
+            for (int l = 0; l < teamsNumber; l++) {
+                k[l] = (int) (rest % dimensions[l]);
+                rest /= dimensions[l];
+                if (k[l] != 0) {
+                    aliveTeams++;
+                    lastAliveTeam = l;
+                    denominator += inverseStrengths[l][k[l]-1];
+                }
+            }
+
+            if (aliveTeams <= 1) {
+                result.probabilities[lastAliveTeam] += (aliveTeams == 1) ? mass : 0;
+                continue;
+            }
+
+            auto weight = mass / denominator;
+            for (int l = 0; l < teamsNumber; l++) {
+                if (k[l] != 0) {
+                    nextFrontier[state - strides[l]] += weight * inverseStrengths[l][k[l]-1];
+                }
+            }
+        }
+
+        auto threshold = epsilon;
+        auto excess = (maxFrontierSize > 0) ? (long long) nextFrontier.size() - maxFrontierSize : 0;
+        if (excess > 0) {
+            /* Порог -- масса (excess + 1)-го по возрастанию состояния. */
+            auto masses = std::vector<double>();
+            masses.reserve(nextFrontier.size());
+            for (auto& [state, mass] : nextFrontier) {
+                masses.push_back(mass);
+            }
+            std::nth_element(masses.begin(), masses.begin() + excess, masses.end());
+            threshold = std::max(threshold, masses[excess]);
+        }
+        for (auto it = nextFrontier.begin(); it != nextFrontier.end();) {
+            if (it->second < threshold) {
+                result.droppedMass += it->second;
+                it = nextFrontier.erase(it);
+            } else {
+                it++;
+            }
+        }
+        /* Состояния с массой, равной порогу, отбрасываются, пока фронт больше ограничения. */
+        for (auto it = nextFrontier.begin(); (excess > 0) && (nextFrontier.size() > maxFrontierSize)
+                                             && (it != nextFrontier.end());) {
+            if (it->second == threshold) {
+                result.droppedMass += it->second;
+                it = nextFrontier.erase(it);
+            } else {
+                it++;
+            }
+        }
+        result.maxFrontierSize = std::max<long long>(result.maxFrontierSize, nextFrontier.size());
+        std::swap(frontier, nextFrontier);
+    }
+}
+
+long long QualityEstimation::statesNumber(const std::vector<StrengthVector>& teams) {
+    long long result = 1;
+    for (auto& team: teams) {
+        if (result > std::numeric_limits<long long>::max() / (team.getLength() + 1)) {
+            return std::numeric_limits<long long>::max();
+        }
+        result *= team.getLength() + 1;
+    }
+    return result;
+}
+
+template double QualityEstimation::probabilityOfWinLeftTeam(const StrengthVector&, const StrengthVector&);
+template float QualityEstimation::probabilityOfWinLeftTeam(const BasicStrengthVector<float>&,
+                                                           const BasicStrengthVector<float>&);
+template double QualityEstimation::probabilityOfWinLeftTeam(const StrengthVector&, const RunLengthTeam&);
+template float QualityEstimation::probabilityOfWinLeftTeam(const BasicStrengthVector<float>&, const RunLengthTeam&);
+template double QualityEstimation::probabilityOfWinLeftTeam(const StrengthVector&, const PreparedOpponent&);
+template float QualityEstimation::probabilityOfWinLeftTeam(const BasicStrengthVector<float>&, const PreparedOpponent&);
+template std::vector<double> QualityEstimation::probabilitiesOfWinAgainstEnsemble(const StrengthVector&,
+                                                                                  const EnemyEnsemble&);
+template std::vector<double> QualityEstimation::probabilitiesOfWinAgainstEnsemble(const BasicStrengthVector<float>&,
+                                                                                  const EnemyEnsemble&);
+template std::vector<double> QualityEstimation::probabilitiesOfWin<double>(const std::vector<RunLengthTeam>&);
+template std::vector<double> QualityEstimation::probabilitiesOfWin<float>(const std::vector<RunLengthTeam>&);
@@ -7,14 +7,74 @@
 
 
 #include "../Gladiator/StrengthVector.h"
+#include "../Gladiator/RunLengthTeam.h"
+#include "../Gladiator/EnemyEnsemble.h"
+#include "../Gladiator/PreparedOpponent.h"
 #include "MultiVector.h"
 #include "MultiIndexGeneric.h"
+#include <future>
 
 
+struct SparseProbabilities {
+    std::vector<double> probabilities;
+    // Отброшенная масса: точная вероятность каждой команды лежит в [p_j, p_j + droppedMass].
+    double droppedMass{0};
+    long long maxFrontierSize{0};
+};
+
 class QualityEstimation {
 public:
-    static double probabilityOfWinLeftTeam(const StrengthVector& leftTeam, const StrengthVector& rightTeam);
+    template <typename Scalar>
+    static Scalar probabilityOfWinLeftTeam(const BasicStrengthVector<Scalar>& leftTeam,
+                                           const BasicStrengthVector<Scalar>& rightTeam);
+    template <typename Scalar>
+    static Scalar probabilityOfWinLeftTeam(const BasicStrengthVector<Scalar>& leftTeam, const RunLengthTeam& rightTeam);
+    template <typename Scalar>
+    static Scalar probabilityOfWinLeftTeam(const BasicStrengthVector<Scalar>& leftTeam, const PreparedOpponent& rightTeam);
+    template <typename Scalar>
+    static std::vector<double> probabilitiesOfWinAgainstEnsemble(const BasicStrengthVector<Scalar>& leftTeam,
+                                                                 const EnemyEnsemble& enemies);
+    static std::vector<double> probabilitiesOfWinLeftTeam(const std::vector<StrengthVector>& leftTeams,
+                                                          const std::vector<StrengthVector>& rightTeams,
+                                                          int threadsNumber=1);
+    static void probabilitiesOfWinLeftTeam(const double* leftTeams, int leftLength, long long leftStride,
+                                           const double* rightTeams, int rightLength, long long rightStride,
+                                           long long duelsNumber, double* result, int threadsNumber=1);
+    static void probabilitiesOfWinLeftTeam(const StrengthVector* leftTeams, int teamsNumber,
+                                           const PreparedOpponent& rightTeam, double* result);
+    static std::vector<double> survivalProbabilities(const StrengthVector& leftTeam, const StrengthVector& rightTeam);
+    static std::vector<std::vector<double>> survivalProbabilities(const std::vector<StrengthVector>& leftTeams,
+                                                                  const StrengthVector& rightTeam,
+                                                                  int threadsNumber=1);
+    static double expectedSurvivorsLeftTeam(const std::vector<double>& survivalProbabilities, int leftLength);
     static std::vector<double> probabilitiesOfWin(const std::vector<StrengthVector>& teams);
+    template <typename Scalar = double>
+    static std::vector<double> probabilitiesOfWin(const std::vector<RunLengthTeam>& teams);
+    static SparseProbabilities probabilitiesOfWinSparse(const std::vector<StrengthVector>& teams,
+                                                        double epsilon,
+                                                        long long maxFrontierSize=0);
+    static bool isSparseRepresentable(const std::vector<StrengthVector>& teams);
+    static long long statesNumber(const std::vector<StrengthVector>& teams);
+private:
+    static constexpr int batchLanes = PreparedOpponent::lanesNumber;
+
+    template <typename Scalar>
+    static Scalar probabilityOfWinLeftTeam(const Scalar* leftTeam, int m, const Scalar* rightTeam, int n);
+    static void probabilitiesOfWinLeftTeamLanes(const double* const* leftTeams, const double* const* rightTeams,
+                                                bool isSharedRight, int m, int n, int lanes, double* result);
+    static void advanceLanes(const double* left, const double* right, bool isSharedRight, int m, int n, int lanes,
+                             double* result);
+    template <typename Key>
+    static void propagateSparse(const std::vector<std::vector<double>>& inverseStrengths,
+                                double epsilon,
+                                long long maxFrontierSize,
+                                SparseProbabilities& result);
+    template <typename Scalar>
+    static void advanceColumn(std::vector<Scalar>& curWinLeft, const BasicStrengthVector<Scalar>& leftTeam,
+                              Scalar rightStrength);
+    template <typename Scalar>
+    static void advanceRun(std::vector<Scalar>& curWinLeft, const BasicStrengthVector<Scalar>& leftTeam,
+                           Scalar rightStrength, int count);
 };
 
 
@@ -3,7 +3,10 @@
 //
 
 
+#include <cmath>
+#include <unordered_map>
 #include "Simulation.h"
+#include "TaskGraph.h"
 
 StrengthVector Simulation::simulationForOneTeamWithOneEnemy(const double totalStrength,
                                                             const int gladiatorNumber,
@@ -11,41 +14,447 @@ StrengthVector Simulation::simulationForOneTeamWithOneEnemy(const double totalSt
                                                             const int generationNumber,
                                                             const int epochs,
                                                             const double mutationCoefficient,
-                                                            const int threadsNumber) {
+                                                            const int threadsNumber,
+                                                            const SimulationOptions& options) {
+    auto seeds = options.solutionStore
+                 ? options.solutionStore->nearestOneTeam(totalStrength, gladiatorNumber, enemy, options.objective,
+                                                         options.warmStartNeighbours)
+                 : std::vector<StrengthVector>();
+    auto state = initialState(CheckpointKind::OneEnemy, {totalStrength}, {gladiatorNumber},
+                              generationNumber, epochs, mutationCoefficient, threadsNumber, {seeds});
+    state.context = std::vector<double>(enemy.getLength());
+    for (int i = 0; i < enemy.getLength(); i++) {
+        state.context[i] = enemy[i];
+    }
+    return solveOneTeamWithOneEnemy(std::move(state), threadsNumber, options);
+}
+
+StrengthVector Simulation::resumeOneTeamWithOneEnemy(const std::string& checkpointPath,
+                                                     const int threadsNumber,
+                                                     const SimulationOptions& options) {
+    /**
+     * Продолжение прерванного `simulationForOneTeamWithOneEnemy` с контрольной точки `checkpointPath`.
+     *
+     * Противник и параметры алгоритма берутся из контрольной точки.
+     * Без `options.screening` продолжение даёт тот же результат, что и непрерванный запуск.
+     */
+    auto state = Checkpoint::read(checkpointPath);
+    if (state.kind != CheckpointKind::OneEnemy) {
+        std::cout << "Checkpoint is not for one team with one enemy: " << checkpointPath << std::endl;
+        exit(-1);
+    }
+    return solveOneTeamWithOneEnemy(std::move(state), threadsNumber, options);
+}
+
+StrengthVector Simulation::solveOneTeamWithOneEnemy(CheckpointState state,
+                                                    const int threadsNumber,
+                                                    const SimulationOptions& options) {
+    auto enemy = StrengthVector(state.context.size());
+    for (int i = 0; i < enemy.getLength(); i++) {
+        enemy[i] = state.context[i];
+    }
+    auto totalStrength = state.totalStrengths[0];
+    auto opponent = (options.preparedOpponent && options.preparedOpponent->matches(enemy))
+                    ? options.preparedOpponent
+                    : std::make_shared<const PreparedOpponent>(enemy);
+    auto select = [&enemy, &opponent, threadsNumber, &options](std::vector<StrengthVector>& generation) {
+        return selectOneTeam(generation, enemy, *opponent, threadsNumber, options);
+    };
+    auto generation = evolveOneTeam(std::move(state), threadsNumber, select, options);
+    /* После отбора в float или с предварительным отбором последнее поколение ранжируется точно. */
+    if ((options.selectionPrecision == Precision::Float) || options.screening) {
+        selectOneTeam(generation, enemy, *opponent, threadsNumber, rescoringOptions(options));
+    }
+    if (options.solutionStore) {
+        options.solutionStore->storeOneTeam(totalStrength, enemy, generation[0], fitness(generation[0], enemy, options),
+                                            options.objective);
+    }
+
+    if (options.verbose) {
+        std::cout << "***** TOP *****" << std::endl;
+        for (int i = 0; i < std::min<int>(7, generation.size()); i++) {
+            std::cout << "Probability of win: " << QualityEstimation::probabilityOfWinLeftTeam(generation[i], enemy) << "; ";
+            if (options.objective == Objective::ExpectedSurvivors) {
+                std::cout << "Expected survivors: " << fitness(generation[i], enemy, options) << "; ";
+            }
+            generation[i].print();
+        }
+        if (options.screening) {
+            options.screening->printStatistics();
+        }
+        if (options.precisionValidation) {
+            options.precisionValidation->printStatistics();
+        }
+    }
+    return generation[0];
+}
+
+StrengthVector Simulation::simulationForOneTeamWithEnemies(const double totalStrength,
+                                                           const int gladiatorNumber,
+                                                           const EnemyEnsemble& enemies,
+                                                           const int generationNumber,
+                                                           const int epochs,
+                                                           const double mutationCoefficient,
+                                                           const int threadsNumber,
+                                                           const SimulationOptions& options) {
+    /*
+     * Оптимизация против набора вероятных противников.
+     *
+     * Качество команды -- взвешенное среднее или наихудшее по набору
+     * значение целевой функции (`options.ensembleAggregation`).
+     */
+    auto isFloat = (options.selectionPrecision == Precision::Float) && (options.objective == Objective::WinProbability);
+    auto exactFitness = [&enemies, &options, isFloat](const StrengthVector& team) {
+        if (isFloat) {
+            return enemies.aggregate(QualityEstimation::probabilitiesOfWinAgainstEnsemble(BasicStrengthVector<float>(team), enemies),
+                                     options.ensembleAggregation);
+        }
+        return fitness(team, enemies, options);
+    };
+    auto referenceFitness = [&enemies, &options](const StrengthVector& team) {
+        return fitness(team, enemies, options);
+    };
+    auto surrogateFitness = [&enemies, &options](const StrengthVector& team) {
+        auto values = std::vector<double>(enemies.getEnemiesNumber());
+        for (int enemy = 0; enemy < enemies.getEnemiesNumber(); enemy++) {
+            values[enemy] = options.screening->estimate(team, enemies.getEnemy(enemy));
+        }
+        return enemies.aggregate(values, options.ensembleAggregation);
+    };
+    auto validation = isFloat ? options.precisionValidation.get() : nullptr;
+    auto select = [&](std::vector<StrengthVector>& generation) {
+        return selectByFitness(generation, exactFitness, surrogateFitness, options.screening.get(),
+                               referenceFitness, validation, threadsNumber);
+    };
+    if (!options.checkpointPath.empty()) {
+        std::cout << "Checkpoints are not supported for an enemy ensemble" << std::endl;
+        exit(-1);
+    }
+    auto state = initialState(CheckpointKind::OneEnemy, {totalStrength}, {gladiatorNumber},
+                              generationNumber, epochs, mutationCoefficient, threadsNumber, {{}});
+    auto generation = evolveOneTeam(std::move(state), threadsNumber, select, options);
+    if (isFloat || options.screening) {
+        selectByFitness(generation, referenceFitness, surrogateFitness, nullptr, referenceFitness, nullptr, threadsNumber);
+    }
+
+    if (options.verbose) {
+        std::cout << "***** TOP *****" << std::endl;
+        for (int i = 0; i < std::min<int>(7, generation.size()); i++) {
+            std::cout << "Ensemble quality: " << referenceFitness(generation[i]) << "; ";
+            generation[i].print();
+        }
+        if (options.screening) {
+            options.screening->printStatistics();
+        }
+        if (options.precisionValidation) {
+            options.precisionValidation->printStatistics();
+        }
+    }
+    return generation[0];
+}
+
+std::vector<StrengthVector> Simulation::simulationForOneTeamWithFitness(const double totalStrength,
+                                                                        const int gladiatorNumber,
+                                                                        const std::function<double(const StrengthVector&)>& fitness,
+                                                                        const std::vector<StrengthVector>& seeds,
+                                                                        const int generationNumber,
+                                                                        const int epochs,
+                                                                        const double mutationCoefficient,
+                                                                        const int threadsNumber,
+                                                                        const SimulationOptions& options) {
+    /**
+     * Оптимизация одной команды по произвольной целевой функции `fitness`.
+     *
+     * Первые команды начального поколения заменяются на `seeds` (тёплый старт).
+     * Возвращает последнее поколение, упорядоченное по убыванию `fitness`;
+     * ничего не печатает и не пишет контрольных точек.
+     * `fitness` вызывается из нескольких потоков одновременно.
+     */
+    auto select = [&fitness, threadsNumber](std::vector<StrengthVector>& generation) {
+        return selectByFitness(generation, fitness, fitness, nullptr, fitness, nullptr, threadsNumber);
+    };
+    auto state = initialState(CheckpointKind::OneEnemy, {totalStrength}, {gladiatorNumber},
+                              generationNumber, epochs, mutationCoefficient, threadsNumber, {seeds});
+    auto fitnessOptions = options;
+    fitnessOptions.checkpointPath.clear();
+    return evolveOneTeam(std::move(state), threadsNumber, select, fitnessOptions);
+}
+
+CheckpointState Simulation::initialState(const CheckpointKind kind,
+                                         const std::vector<double>& totalStrengths,
+                                         const std::vector<int>& gladiatorNumbers,
+                                         const int generationNumber,
+                                         const int epochs,
+                                         const double mutationCoefficient,
+                                         const int threadsNumber,
+                                         const std::vector<std::vector<StrengthVector>>& seeds) {
+    /**
+     * Начальное состояние алгоритма: случайные популяции,
+     * первые команды которых заменены на `seeds` соответствующей популяции.
+     */
     std::default_random_engine randomGenerator;
     std::random_device rd;
-    std::mt19937 uniformGenerator(rd());
-    auto generation = initialize(totalStrength, gladiatorNumber, generationNumber, randomGenerator, threadsNumber);
-    auto selectedNumber = std::trunc(generation.size() * mutationCoefficient);
-
-    for (int epoch = 0; epoch < epochs; epoch++) {
-        selectOneTeam(generation, enemy, threadsNumber);
-        auto mutationTeams = mutate(std::vector<StrengthVector>(generation.begin(), generation.begin() + selectedNumber),
-                                    uniformGenerator,
-                                    threadsNumber);
+    auto state = CheckpointState();
+    state.kind = kind;
+    state.epochs = epochs;
+    state.generationNumber = generationNumber;
+    state.mutationCoefficient = mutationCoefficient;
+    state.totalStrengths = totalStrengths;
+    state.gladiatorNumbers = gladiatorNumbers;
+    state.generations = std::vector<std::vector<StrengthVector>>(totalStrengths.size());
+    state.randomGenerator = std::mt19937(rd());
+    for (int p = 0; p < totalStrengths.size(); p++) {
+        state.generations[p] = initialize(totalStrengths[p], gladiatorNumbers[p], generationNumber, randomGenerator, threadsNumber);
+        for (int i = 0; i < std::min<int>(seeds[p].size(), generationNumber); i++) {
+            state.generations[p][i] = seeds[p][i];
+        }
+    }
+    return state;
+}
 
-        auto crossbredTeams = crossbreed(std::vector<StrengthVector>(generation.begin(), generation.begin() + selectedNumber),
-                                         generationNumber - selectedNumber,
-                                         uniformGenerator,
-                                         threadsNumber);
+std::vector<StrengthVector> Simulation::evolveOneTeam(CheckpointState state,
+                                                      const int threadsNumber,
+                                                      const std::function<std::vector<double>(std::vector<StrengthVector>&)>& select,
+                                                      const SimulationOptions& options) {
+    /**
+     * Эпохи генетического алгоритма для одной популяции, начиная с `state.epoch`.
+     *
+     * Каждая эпоха строит новое поколение из лучших команд текущего и ранжирует его.
+     * Если задан `options.checkpointPath`, раз в `options.checkpointPeriod` эпох
+     * фоновому потоку передаётся ранжированное поколение до изменения
+     * вместе с оценками и состоянием генератора; поколение не копируется,
+     * так как оно всё равно заменяется новым.
+     */
+    auto selectedNumber = (int) std::trunc(state.generationNumber * state.mutationCoefficient);
+    auto writer = checkpointWriter(options);
+    if (state.scores.empty()) {
+        state.scores = {select(state.generations[0])};
+    }
 
-        for (int i = 0; i < selectedNumber; i++) {
-            generation[i] = mutationTeams[i];
+    for (; state.epoch < state.epochs; state.epoch++) {
+        if (options.jobControl && options.jobControl->isCancelled()) {
+            break;
         }
+        auto randomGenerator = state.randomGenerator;
+        auto nextGeneration = breed(state.generations[0], selectedNumber, state.randomGenerator, threadsNumber, options);
+        std::swap(state.generations[0], nextGeneration);
+        if (writer && (state.epoch % options.checkpointPeriod == 0)) {
+            submitCheckpoint(*writer, state, {std::move(nextGeneration)}, std::move(state.scores), randomGenerator);
+        }
+        state.scores = {select(state.generations[0])};
+        reportProgress(options, state);
+    }
+    return state.generations[0];
+}
+
+void Simulation::reportProgress(const SimulationOptions& options, const CheckpointState& state) {
+    if (!options.jobControl) {
+        return;
+    }
+    auto progress = JobProgress{state.epoch + 1, state.epochs, std::vector<double>(state.scores.size())};
+    for (int p = 0; p < state.scores.size(); p++) {
+        progress.bestFitness[p] = state.scores[p][0];
+    }
+    options.jobControl->reportProgress(progress);
+}
+
+std::vector<StrengthVector> Simulation::breed(const std::vector<StrengthVector>& generation,
+                                              const int selectedNumber,
+                                              std::mt19937& randomGenerator,
+                                              const int threadsNumber,
+                                              const SimulationOptions& options) {
+    /* Новое поколение: мутации первых `selectedNumber` команд, затем их скрещивания. */
+    auto variation = drawVariation(generation.size(), generation[0].getLength(), selectedNumber, randomGenerator);
+    auto nextGeneration = std::vector<StrengthVector>(generation.size());
+    parallelFor(generation.size(), threadsNumber, [&](const int i) {
+        nextGeneration[i] = offspring(generation, variation, i);
+    });
+    deduplicate(nextGeneration, randomGenerator, threadsNumber, options);
+    return nextGeneration;
+}
+
+std::vector<std::vector<StrengthVector>> Simulation::breedTeams(const std::vector<std::vector<StrengthVector>>& generations,
+                                                                const int selectedNumber,
+                                                                std::mt19937& randomGenerator,
+                                                                const int threadsNumber,
+                                                                const SimulationOptions& options) {
+    /*
+     * Новые поколения всех популяций одним графом задач.
+     *
+     * Случайные числа всех популяций выбираются заранее в вызывающем потоке,
+     * для удаления повторов каждой популяции -- свой генератор с выбранным здесь зерном.
+     * Потомки каждой популяции считаются `threadsNumber` частями, удаление повторов
+     * популяции зависит только от её частей, и между популяциями нет общих барьеров.
+     */
+    int populationsNumber = generations.size();
+    auto variations = std::vector<Variation>(populationsNumber);
+    auto deduplicationGenerators = std::vector<std::mt19937>(populationsNumber);
+    for (int j = 0; j < populationsNumber; j++) {
+        variations[j] = drawVariation(generations[j].size(), generations[j][0].getLength(), selectedNumber, randomGenerator);
+        deduplicationGenerators[j] = std::mt19937(randomGenerator());
+    }
 
-        for (int i = selectedNumber; i < generationNumber; i++) {
-            generation[i] = crossbredTeams[i - selectedNumber];
+    auto nextGenerations = std::vector<std::vector<StrengthVector>>(populationsNumber);
+    auto graph = TaskGraph();
+    for (int j = 0; j < populationsNumber; j++) {
+        int generationSize = generations[j].size();
+        nextGenerations[j] = std::vector<StrengthVector>(generationSize);
+        auto chunksNumber = std::max(1, std::min(threadsNumber, generationSize));
+        auto chunks = std::vector<int>(chunksNumber);
+        for (int chunk = 0; chunk < chunksNumber; chunk++) {
+            auto begin = generationSize * chunk / chunksNumber;
+            auto end = generationSize * (chunk + 1) / chunksNumber;
+            chunks[chunk] = graph.addTask([&generations, &nextGenerations, &variations, j, begin, end]() {
+                for (int i = begin; i < end; i++) {
+                    nextGenerations[j][i] = offspring(generations[j], variations[j], i);
+                }
+            });
         }
+        graph.addTask([&nextGenerations, &deduplicationGenerators, &options, j]() {
+            deduplicate(nextGenerations[j], deduplicationGenerators[j], 1, options);
+        }, chunks);
     }
+    graph.run(threadsNumber);
+    return nextGenerations;
+}
 
-    selectOneTeam(generation, enemy, threadsNumber);
+Simulation::Variation Simulation::drawVariation(const int generationSize,
+                                                const int gladiatorNumber,
+                                                const int selectedNumber,
+                                                std::mt19937& randomGenerator) {
+    /*
+     * Случайные числа для `offspring`: сначала для мутаций первых `selectedNumber` команд
+     * (пара гладиаторов и доля их суммарной силы), затем для скрещиваний
+     * (пара из отобранных команд и коэффициент выпуклой комбинации).
+     * Числа выбираются последовательно в вызывающем потоке,
+     * поэтому результат не зависит от `threadsNumber` и расписания потоков.
+     */
+    auto variation = Variation{selectedNumber, std::vector<int>(generationSize), std::vector<int>(generationSize),
+                               std::vector<double>(generationSize)};
+    std::uniform_int_distribution<> firstMutatedGladiatorDistribution(0, gladiatorNumber-1);
+    std::uniform_int_distribution<> secondMutatedGladiatorDistribution(0, gladiatorNumber-2);
+    std::uniform_real_distribution<> linearCoefficientDistribution(0, 1);
+    for (int i = 0; i < selectedNumber; i++) {
+        variation.firstIndices[i] = firstMutatedGladiatorDistribution(randomGenerator);
+        variation.secondIndices[i] = secondMutatedGladiatorDistribution(randomGenerator);
+        variation.secondIndices[i] += (variation.secondIndices[i] >= variation.firstIndices[i]) ? 1 : 0;
+        variation.alphas[i] = linearCoefficientDistribution(randomGenerator);
+    }
 
-    std::cout << "***** TOP *****" << std::endl;
-    for (int i = 0; i < 7; i++) {
-        std::cout << "Probability of win: " << QualityEstimation::probabilityOfWinLeftTeam(generation[i], enemy) << "; ";
-        generation[i].print();
+    std::uniform_int_distribution<> firstItemDistribution(0, selectedNumber-1);
+    std::uniform_int_distribution<> secondItemDistribution(0, selectedNumber-2);
+    for (int i = selectedNumber; i < generationSize; i++) {
+        variation.firstIndices[i] = firstItemDistribution(randomGenerator);
+        variation.secondIndices[i] = secondItemDistribution(randomGenerator);
+        variation.secondIndices[i] += (variation.secondIndices[i] >= variation.firstIndices[i]) ? 1 : 0;
+        variation.alphas[i] = linearCoefficientDistribution(randomGenerator);
+    }
+    return variation;
+}
+
+StrengthVector Simulation::offspring(const std::vector<StrengthVector>& generation,
+                                     const Variation& variation,
+                                     const int i) {
+    /* Потомок `i`: мутация команды `i` при `i` < `selectedNumber`, иначе скрещивание двух отобранных команд. */
+    auto alpha = variation.alphas[i];
+    if (i < variation.selectedNumber) {
+        auto mutatedTeam = generation[i];
+        auto sumPairStrength = mutatedTeam[variation.firstIndices[i]] + mutatedTeam[variation.secondIndices[i]];
+        mutatedTeam[variation.firstIndices[i]] = sumPairStrength * alpha;
+        mutatedTeam[variation.secondIndices[i]] = sumPairStrength * (1 - alpha);
+        return mutatedTeam;
+    }
+    return generation[variation.firstIndices[i]] * alpha + generation[variation.secondIndices[i]] * (1 - alpha);
+}
+
+void Simulation::deduplicate(std::vector<StrengthVector>& generation,
+                             std::mt19937& randomGenerator,
+                             const int threadsNumber,
+                             const SimulationOptions& options) {
+    /*
+     * Канонический вид и замена повторов (см. `SimulationOptions::deduplication`).
+     *
+     * Перестановки одной команды и почти одинаковые потомки выпуклого скрещивания
+     * иначе оцениваются как разные команды и быстро вытесняют разнообразие.
+     * Повтором считается команда, равная (с точностью `deduplicationTolerance`) одной
+     * из предыдущих команд поколения с тем же хэшем, поэтому остаётся первая из равных команд,
+     * а совпадение хэшей разных команд повтором не считается. Случайные числа для новых команд
+     * выбираются последовательно, результат не зависит от `threadsNumber`.
+     */
+    if (!options.deduplication) {
+        return;
+    }
+    int generationSize = generation.size();
+    auto isCanonical = (options.objective == Objective::WinProbability);
+    auto hashes = std::vector<size_t>(generationSize);
+    parallelFor(generationSize, threadsNumber, [&](const int i) {
+        if (isCanonical) {
+            generation[i] = generation[i].canonical();
+        }
+        hashes[i] = generation[i].hash(options.deduplicationTolerance);
+    });
+
+    auto seenTeams = std::unordered_map<size_t, std::vector<int>>();
+    auto isSeen = [&generation, &seenTeams, &options](const size_t hash, const StrengthVector& team) {
+        auto it = seenTeams.find(hash);
+        if (it == seenTeams.end()) {
+            return false;
+        }
+        for (auto seen: it->second) {
+            if (generation[seen].isSame(team, options.deduplicationTolerance)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    std::exponential_distribution<double> distribution(1);
+    for (int i = 0; i < generationSize; i++) {
+        if (!isSeen(hashes[i], generation[i])) {
+            seenTeams[hashes[i]].push_back(i);
+            continue;
+        }
+        auto& team = generation[i];
+        double totalStrength = 0;
+        double randomValuesSum = 0;
+        for (int j = 0; j < team.getLength(); j++) {
+            totalStrength += team[j];
+            team[j] = distribution(randomGenerator);
+            randomValuesSum += team[j];
+        }
+        team *= totalStrength / randomValuesSum;
+        if (isCanonical) {
+            team = team.canonical();
+        }
+        seenTeams[team.hash(options.deduplicationTolerance)].push_back(i);
     }
-    return generation[0];
+}
+
+std::unique_ptr<CheckpointWriter> Simulation::checkpointWriter(const SimulationOptions& options) {
+    if (options.checkpointPeriod <= 0) {
+        std::cout << "Wrong checkpoint period: " << options.checkpointPeriod << std::endl;
+        exit(-1);
+    }
+    return options.checkpointPath.empty() ? nullptr : std::make_unique<CheckpointWriter>(options.checkpointPath);
+}
+
+void Simulation::submitCheckpoint(CheckpointWriter& writer,
+                                  const CheckpointState& state,
+                                  std::vector<std::vector<StrengthVector>> generations,
+                                  std::vector<std::vector<double>> scores,
+                                  const std::mt19937& randomGenerator) {
+    auto snapshot = CheckpointState();
+    snapshot.kind = state.kind;
+    snapshot.epoch = state.epoch;
+    snapshot.epochs = state.epochs;
+    snapshot.generationNumber = state.generationNumber;
+    snapshot.mutationCoefficient = state.mutationCoefficient;
+    snapshot.totalStrengths = state.totalStrengths;
+    snapshot.gladiatorNumbers = state.gladiatorNumbers;
+    snapshot.context = state.context;
+    snapshot.generations = std::move(generations);
+    snapshot.scores = std::move(scores);
+    snapshot.randomGenerator = randomGenerator;
+    writer.submit(std::move(snapshot));
 }
 
 std::vector<StrengthVector> Simulation::initialize(const double totalStrength,
@@ -55,113 +464,188 @@ std::vector<StrengthVector> Simulation::initialize(const double totalStrength,
                                                    const int threadsNumber) {
     auto initialGeneration = std::vector<StrengthVector>(generationNumber);
     std::exponential_distribution<double> distribution(1);
-    auto futures = std::vector<std::future<StrengthVector>>((unsigned long) threadsNumber);
+    auto randomValues = std::vector<double>((size_t) generationNumber * gladiatorNumber);
+    for (auto& value: randomValues) {
+        value = distribution(randomGenerator);
+    }
 
-    auto createTeam = [gladiatorNumber, &distribution, &randomGenerator, totalStrength]() {
+    parallelFor(generationNumber, threadsNumber, [&](const int i) {
         auto team = StrengthVector(gladiatorNumber);
         double randomValuesSum = 0;
         for (int j = 0; j < gladiatorNumber; j++) {
-            auto strength = distribution(randomGenerator);
+            auto strength = randomValues[(size_t) i * gladiatorNumber + j];
             randomValuesSum += strength;
             team[j] = strength;
         }
         team *= totalStrength / randomValuesSum;
-        return team;
-    };
-    for (int i = 0; i < generationNumber; i++) {
-        futures[i % threadsNumber] = std::async(std::launch::async, createTeam);
-        if (((i + 1) % threadsNumber == 0) || (i + 1 == generationNumber)) {
-            auto startIndex = threadsNumber * (i / threadsNumber);
-            for (int k = 0; k < std::min(threadsNumber, generationNumber - startIndex); k++) {
-                initialGeneration[startIndex + k] = futures[k].get();
-            }
-        }
-    }
+        initialGeneration[i] = team;
+    });
     return initialGeneration;
 }
 
-void Simulation::selectOneTeam(std::vector<StrengthVector>& generation,
-                               const StrengthVector& enemy,
-                               const int threadsNumber) {
-    auto qualityFunction = [enemy, threadsNumber](StrengthVector &firstLeftTeam, StrengthVector &secondLeftTeam) {
-        if (threadsNumber > 1) {
-            auto futureLeftTeam = std::async(std::launch::async, QualityEstimation::probabilityOfWinLeftTeam, firstLeftTeam, enemy);
-            auto futureRightTeam = std::async(std::launch::async, QualityEstimation::probabilityOfWinLeftTeam, secondLeftTeam, enemy);
-            return futureLeftTeam.get() > futureRightTeam.get();
-        } else {
-            return QualityEstimation::probabilityOfWinLeftTeam(firstLeftTeam, enemy) > QualityEstimation::probabilityOfWinLeftTeam(secondLeftTeam, enemy);
+std::vector<double> Simulation::selectOneTeam(std::vector<StrengthVector>& generation,
+                                              const StrengthVector& enemy,
+                                              const PreparedOpponent& opponent,
+                                              const int threadsNumber,
+                                              const SimulationOptions& options) {
+    /*
+     * Сортировка поколения по целевой функции `options.objective` против `enemy`.
+     *
+     * Вероятность победы считается против подготовленного `opponent`
+     * (для противника из нескольких одинаковых гладиаторов -- по сериям).
+     * При `Precision::Float` вероятность победы считается в float,
+     * а `options.precisionValidation` периодически сравнивает её с double.
+     */
+    auto isWinProbability = (options.objective == Objective::WinProbability);
+    auto isFloat = (options.selectionPrecision == Precision::Float) && isWinProbability;
+    auto exactFitness = [&](const StrengthVector& team) -> double {
+        if (isFloat) {
+            return QualityEstimation::probabilityOfWinLeftTeam(BasicStrengthVector<float>(team), opponent);
         }
+        return isWinProbability ? QualityEstimation::probabilityOfWinLeftTeam(team, opponent)
+                                : fitness(team, enemy, options);
+    };
+    auto surrogateFitness = [&](const StrengthVector& team) {
+        return options.screening->estimate(team, enemy);
     };
-    std::sort(generation.begin(), generation.end(), qualityFunction);
+    auto referenceFitness = [&](const StrengthVector& team) {
+        return isWinProbability ? QualityEstimation::probabilityOfWinLeftTeam(team, opponent)
+                                : fitness(team, enemy, options);
+    };
+    auto exactBatchFitness = std::function<std::vector<double>(const std::vector<StrengthVector>&, int)>();
+    if (options.batchedSelection && !isFloat && isWinProbability) {
+        exactBatchFitness = [&opponent, threadsNumber](const std::vector<StrengthVector>& teams, const int count) {
+            /* Каждая из частей поколения считается пакетным ядром в своём потоке, без копирования команд. */
+            auto scores = std::vector<double>(count);
+            auto chunksNumber = std::max(1, std::min(threadsNumber, count));
+            parallelFor(chunksNumber, chunksNumber, [&teams, &opponent, &scores, count, chunksNumber](const int chunk) {
+                auto begin = (long long) count * chunk / chunksNumber;
+                auto end = (long long) count * (chunk + 1) / chunksNumber;
+                QualityEstimation::probabilitiesOfWinLeftTeam(teams.data() + begin, (int) (end - begin), opponent,
+                                                              scores.data() + begin);
+            });
+            return scores;
+        };
+    }
+    return selectByFitness(generation, exactFitness, surrogateFitness, options.screening.get(),
+                           referenceFitness, isFloat ? options.precisionValidation.get() : nullptr, threadsNumber,
+                           exactBatchFitness);
 }
 
-std::vector<StrengthVector> Simulation::crossbreed(std::vector<StrengthVector> generation,
-                                                   const int crossbredGenerationNumber,
-                                                   std::mt19937 randomGenerator,
-                                                   const int threadsNumber) {
-    auto crossbredGeneration = std::vector<StrengthVector>(crossbredGenerationNumber);
-    std::uniform_int_distribution<> firstItemDistribution(0, generation.size()-1);
-    std::uniform_int_distribution<> secondItemDistribution(0, generation.size()-2);
-    std::uniform_real_distribution<> linearCoefficientDistribution(0, 1);
-    auto futures = std::vector<std::future<StrengthVector>>((unsigned long) threadsNumber);
-
-    auto createTeam = [generation, &firstItemDistribution, &secondItemDistribution,
-                       &linearCoefficientDistribution, &randomGenerator]() {
-        auto firstTeamIndex = firstItemDistribution(randomGenerator);
-        auto secondTeamIndex = secondItemDistribution(randomGenerator);
-        secondTeamIndex += (secondTeamIndex >= firstTeamIndex) ? 1 : 0;
-        auto alpha = linearCoefficientDistribution(randomGenerator);
+std::vector<double> Simulation::selectByFitness(std::vector<StrengthVector>& generation,
+                                                const std::function<double(const StrengthVector&)>& exactFitness,
+                                                const std::function<double(const StrengthVector&)>& surrogateFitness,
+                                                SurrogateScreening* screening,
+                                                const std::function<double(const StrengthVector&)>& referenceFitness,
+                                                PrecisionValidation* validation,
+                                                const int threadsNumber,
+                                                const std::function<std::vector<double>(const std::vector<StrengthVector>&, int)>&
+                                                        exactBatchFitness) {
+    /*
+     * Сортировка поколения по убыванию `exactFitness`.
+     *
+     * Каждая команда оценивается один раз. Если задан `screening`,
+     * поколение сначала упорядочивается по дешёвой оценке `surrogateFitness`,
+     * и точно оцениваются только первые `exactNumber` команд,
+     * остальные остаются в порядке дешёвой оценки.
+     * Если задан `validation`, в отборы аудита те же команды оцениваются
+     * и `referenceFitness`, и расхождение оценок передаётся в `validation`.
+     * Если задан `exactBatchFitness`, первые `exactNumber` команд оцениваются им одним вызовом.
+     * Возвращает точные оценки команд после сортировки (NaN для неоценённых).
+     */
+    int generationSize = generation.size();
+    int exactNumber = generationSize;
+    auto surrogateScores = std::vector<double>(generationSize);
+
+    if (screening != nullptr) {
+        parallelFor(generationSize, threadsNumber, [&](const int i) {
+            surrogateScores[i] = surrogateFitness(generation[i]);
+        });
+        sortByScores(generation, surrogateScores, generationSize);
+        exactNumber = screening->nextExactNumber(generationSize);
+    }
 
-        return generation[firstTeamIndex] * alpha + generation[secondTeamIndex] * (1 - alpha);
-    };
+    auto exactScores = std::vector<double>(exactNumber);
+    if (exactBatchFitness) {
+        exactScores = exactBatchFitness(generation, exactNumber);
+    } else {
+        parallelFor(exactNumber, threadsNumber, [&](const int i) {
+            exactScores[i] = exactFitness(generation[i]);
+        });
+    }
 
-    for (int i = 0; i < crossbredGenerationNumber; i++) {
-        futures[i % threadsNumber] = std::async(std::launch::async, createTeam);
-        if (((i + 1) % threadsNumber == 0) || (i + 1 == crossbredGenerationNumber)) {
-            auto startIndex = threadsNumber * (i / threadsNumber);
-            for (int k = 0; k < std::min(threadsNumber, crossbredGenerationNumber - startIndex); k++) {
-                crossbredGeneration[k + startIndex] = futures[k].get();
-            }
-        }
+    if ((validation != nullptr) && validation->nextAudit()) {
+        auto referenceScores = std::vector<double>(exactNumber);
+        parallelFor(exactNumber, threadsNumber, [&](const int i) {
+            referenceScores[i] = referenceFitness(generation[i]);
+        });
+        validation->report(exactScores, referenceScores);
+    }
+    if (screening != nullptr) {
+        screening->report(std::vector<double>(surrogateScores.begin(), surrogateScores.begin() + exactNumber),
+                          exactScores,
+                          generationSize);
     }
-    return crossbredGeneration;
+    sortByScores(generation, exactScores, exactNumber);
+    exactScores.resize(generationSize, NAN);
+    return exactScores;
 }
 
-std::vector<StrengthVector> Simulation::mutate(std::vector<StrengthVector> generation,
-                                               std::mt19937 randomGenerator,
-                                               const int threadsNumber) {
-    auto mutatedGeneration = std::vector<StrengthVector>(generation.size());
-    std::uniform_int_distribution<> firstMutatedGladiatorDistribution(0, generation[0].getLength()-1);
-    std::uniform_int_distribution<> secondMutatedGladiatorDistribution(0, generation[0].getLength()-2);
-    std::uniform_real_distribution<> linearCoefficientDistribution(0, 1);
-    auto futures = std::vector<std::future<StrengthVector>>((unsigned long) threadsNumber);
-
-    auto createTeam = [generation, &firstMutatedGladiatorDistribution, &secondMutatedGladiatorDistribution,
-            &linearCoefficientDistribution, &randomGenerator](const int i) {
-        auto firstGladiatorIndex = firstMutatedGladiatorDistribution(randomGenerator);
-        auto secondGladiatorIndex = secondMutatedGladiatorDistribution(randomGenerator);
-        secondGladiatorIndex += (secondGladiatorIndex >= firstGladiatorIndex) ? 1 : 0;
-        auto alpha = linearCoefficientDistribution(randomGenerator);
+double Simulation::fitness(const StrengthVector& team, const StrengthVector& enemy, const SimulationOptions& options) {
+    if (options.objective == Objective::ExpectedSurvivors) {
+        return QualityEstimation::expectedSurvivorsLeftTeam(QualityEstimation::survivalProbabilities(team, enemy),
+                                                            team.getLength());
+    }
+    return QualityEstimation::probabilityOfWinLeftTeam(team, enemy);
+}
 
-        auto mutatedTeam = generation[i];
+double Simulation::fitness(const StrengthVector& team, const EnemyEnsemble& enemies, const SimulationOptions& options) {
+    if (options.objective == Objective::ExpectedSurvivors) {
+        auto values = std::vector<double>(enemies.getEnemiesNumber());
+        for (int enemy = 0; enemy < enemies.getEnemiesNumber(); enemy++) {
+            values[enemy] = fitness(team, enemies.getEnemy(enemy), options);
+        }
+        return enemies.aggregate(values, options.ensembleAggregation);
+    }
+    return enemies.aggregate(QualityEstimation::probabilitiesOfWinAgainstEnsemble(team, enemies),
+                             options.ensembleAggregation);
+}
 
-        auto sumPairStrength = mutatedTeam[firstGladiatorIndex] + mutatedTeam[secondGladiatorIndex];
-        mutatedTeam[firstGladiatorIndex] = sumPairStrength * alpha;
-        mutatedTeam[secondGladiatorIndex] = sumPairStrength * (1 - alpha);
+TournamentBackend Simulation::tournamentBackend(const std::vector<StrengthVector>& teams, const SimulationOptions& options) {
+    /* Способ оценки турнира команд таких длин, как `teams`, с раскрытым `TournamentBackend::Automatic`. */
+    if (options.tournamentBackend != TournamentBackend::Automatic) {
+        return options.tournamentBackend;
+    }
+    if (QualityEstimation::statesNumber(teams) > options.denseStatesLimit) {
+        return options.monteCarlo ? TournamentBackend::MonteCarlo : TournamentBackend::Sparse;
+    }
+    return (options.sparseEpsilon > 0) ? TournamentBackend::Sparse : TournamentBackend::Dense;
+}
 
-        return mutatedTeam;
-    };
+void Simulation::parallelFor(const int count, const int threadsNumber, const std::function<void(int)>& body) {
+    /* Параллельный цикл из `threadsNumber` частей, см. `Executor::parallelFor`. */
+    Executor::parallelFor(count, threadsNumber, body);
+}
 
-    for (int i = 0; i < generation.size(); i++) {
-        futures[i % threadsNumber] = std::async(std::launch::async, createTeam, i);
-        if (((i + 1) % threadsNumber == 0) || (i + 1 == generation.size())) {
-            auto startIndex = threadsNumber * (i / threadsNumber);
-            for (int k = 0; k < std::min(threadsNumber, int(generation.size()) - startIndex); k++) {
-                mutatedGeneration[k + startIndex] = futures[k].get();
-            }
-        }
+void Simulation::sortByScores(std::vector<StrengthVector>& generation, std::vector<double>& scores, const int count) {
+    auto order = std::vector<int>(count);
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&scores](int i, int j) {
+        return scores[i] > scores[j];
+    });
+
+    auto sortedTeams = std::vector<StrengthVector>(count);
+    auto sortedScores = std::vector<double>(count);
+    for (int i = 0; i < count; i++) {
+        sortedTeams[i] = generation[order[i]];
+        sortedScores[i] = scores[order[i]];
+    }
+    for (int i = 0; i < count; i++) {
+        generation[i] = sortedTeams[i];
+        scores[i] = sortedScores[i];
     }
-    return mutatedGeneration;
 }
 
 std::vector<StrengthVector> Simulation::simulationTeams(const std::vector<double> totalStrengths,
@@ -169,54 +653,91 @@ std::vector<StrengthVector> Simulation::simulationTeams(const std::vector<double
                                                         const int generationNumber,
                                                         const int epochs,
                                                         const double mutationCoefficient,
-                                                        const int threadsNumber) {
-    std::default_random_engine randomGenerator;
-    std::random_device rd;
-    std::mt19937 uniformGenerator(rd());
-    auto generations = std::vector<std::vector<StrengthVector>>(totalStrengths.size());
-    auto selectedNumbers = std::vector<int>(totalStrengths.size());
-    for (int i = 0; i < totalStrengths.size(); i++) {
-        generations[i] = initialize(totalStrengths[i], gladiatorNumbers[i], generationNumber, randomGenerator, threadsNumber);
-        selectedNumbers[i] = std::trunc(generations[i].size() * mutationCoefficient);
-    }
-
-    for (int epoch = 0; epoch < epochs; epoch++) {
-        selectSomeTeams(generations, threadsNumber);
-        for (int j = 0; j < totalStrengths.size(); j++) {
-            auto mutationTeams = mutate(std::vector<StrengthVector>(generations[j].begin(), generations[j].begin() + selectedNumbers[j]),
-                                        uniformGenerator,
-                                        threadsNumber);
-
-            auto crossbredTeams = crossbreed(std::vector<StrengthVector>(generations[j].begin(), generations[j].begin() + selectedNumbers[j]),
-                                             generationNumber - selectedNumbers[j],
-                                             uniformGenerator,
-                                             threadsNumber);
-
-            for (int i = 0; i < selectedNumbers[i]; i++) {
-                generations[j][i] = mutationTeams[i];
-            }
+                                                        const int threadsNumber,
+                                                        const SimulationOptions& options) {
+    auto neighbours = options.solutionStore
+                      ? options.solutionStore->nearestTeams(totalStrengths, gladiatorNumbers, options.warmStartNeighbours)
+                      : std::vector<std::vector<StrengthVector>>();
+    auto seeds = std::vector<std::vector<StrengthVector>>(totalStrengths.size());
+    for (auto& neighbour: neighbours) {
+        for (int i = 0; i < totalStrengths.size(); i++) {
+            seeds[i].push_back(neighbour[i]);
+        }
+    }
+    auto state = initialState(CheckpointKind::Teams, totalStrengths, gladiatorNumbers,
+                              generationNumber, epochs, mutationCoefficient, threadsNumber, seeds);
+    return evolveTeams(std::move(state), threadsNumber, options);
+}
 
-            for (int i = selectedNumbers[j]; i < generationNumber; i++) {
-                generations[j][i] = crossbredTeams[i - selectedNumbers[j]];
-            }
+std::vector<StrengthVector> Simulation::resumeTeams(const std::string& checkpointPath,
+                                                    const int threadsNumber,
+                                                    const SimulationOptions& options) {
+    /* Продолжение прерванного `simulationTeams` с контрольной точки `checkpointPath`. */
+    auto state = Checkpoint::read(checkpointPath);
+    if (state.kind != CheckpointKind::Teams) {
+        std::cout << "Checkpoint is not for teams: " << checkpointPath << std::endl;
+        exit(-1);
+    }
+    return evolveTeams(std::move(state), threadsNumber, options);
+}
+
+std::vector<StrengthVector> Simulation::evolveTeams(CheckpointState state,
+                                                    const int threadsNumber,
+                                                    const SimulationOptions& options) {
+    /* Эпохи для всех популяций сразу, контрольные точки -- как в `evolveOneTeam`. */
+    double maxDroppedMass = 0;
+    auto populationsNumber = state.generations.size();
+    auto selectedNumber = (int) std::trunc(state.generationNumber * state.mutationCoefficient);
+    auto writer = checkpointWriter(options);
+    if (state.scores.empty()) {
+        state.scores = selectSomeTeams(state.generations, threadsNumber, options, maxDroppedMass);
+    }
+
+    for (; state.epoch < state.epochs; state.epoch++) {
+        if (options.jobControl && options.jobControl->isCancelled()) {
+            break;
+        }
+        auto randomGenerator = state.randomGenerator;
+        auto nextGenerations = breedTeams(state.generations, selectedNumber, state.randomGenerator, threadsNumber, options);
+        std::swap(state.generations, nextGenerations);
+        if (writer && (state.epoch % options.checkpointPeriod == 0)) {
+            submitCheckpoint(*writer, state, std::move(nextGenerations), std::move(state.scores), randomGenerator);
         }
+        state.scores = selectSomeTeams(state.generations, threadsNumber, options, maxDroppedMass);
+        reportProgress(options, state);
+    }
+    if (options.selectionPrecision == Precision::Float) {
+        state.scores = selectSomeTeams(state.generations, threadsNumber, rescoringOptions(options), maxDroppedMass);
     }
 
-    auto probabilities = selectSomeTeams(generations, threadsNumber);
+    auto& generations = state.generations;
+    auto& probabilities = state.scores;
 
-    std::cout << "***** TOP *****" << std::endl << std::endl << std::endl;
-    for (int i = 0; i < totalStrengths.size(); i++) {
-        std::cout << std::endl << "***** Team " << i << " *****" << std::endl;
-        for (int j = 0; j < 3; j++) {
-            std::cout << "Probability of win: " << probabilities[i][j] << std::endl;
-            generations[i][j].print();
+    if (options.verbose) {
+        std::cout << "***** TOP *****" << std::endl << std::endl << std::endl;
+        for (int i = 0; i < populationsNumber; i++) {
+            std::cout << std::endl << "***** Team " << i << " *****" << std::endl;
+            for (int j = 0; j < std::min<int>(3, generations[i].size()); j++) {
+                std::cout << "Probability of win: " << probabilities[i][j] << std::endl;
+                generations[i][j].print();
+            }
+        }
+        std::cout << std::endl;
+        if (maxDroppedMass > 0) {
+            std::cout << "Sparse tournaments: max dropped mass " << maxDroppedMass << std::endl;
+        }
+        if (options.precisionValidation) {
+            options.precisionValidation->printStatistics();
         }
     }
 
-    auto topTeams = std::vector<StrengthVector>(totalStrengths.size());
-    for (int i = 0; i < totalStrengths.size(); i++) {
+    auto topTeams = std::vector<StrengthVector>(populationsNumber);
+    for (int i = 0; i < populationsNumber; i++) {
         topTeams[i] = generations[i][0];
     }
+    if (options.solutionStore) {
+        options.solutionStore->storeTeams(topTeams, probabilities[0][0]);
+    }
 
     return topTeams;
 }
@@ -247,48 +768,134 @@ void unzip(
 }
 
 std::vector<std::vector<double>> Simulation::selectSomeTeams(std::vector<std::vector<StrengthVector>>& generations,
-                                                             const int threadsNumber) {
+                                                             const int threadsNumber,
+                                                             const SimulationOptions& options,
+                                                             double& maxDroppedMass) {
+    /*
+     * Сортировка всех популяций по средней вероятности победы в турнирах.
+     *
+     * При `Precision::Float` в отборы аудита те же вероятности
+     * пересчитываются в double для `options.precisionValidation`.
+     */
+    auto probabilitiesOfWin = tournamentProbabilities(generations, threadsNumber, options, maxDroppedMass);
+    auto validation = options.precisionValidation;
+    if ((options.selectionPrecision == Precision::Float) && validation && validation->nextAudit()) {
+        auto exactProbabilitiesOfWin = tournamentProbabilities(generations, threadsNumber, rescoringOptions(options),
+                                                               maxDroppedMass);
+        auto fastScores = std::vector<double>();
+        auto exactScores = std::vector<double>();
+        for (int i = 0; i < generations.size(); i++) {
+            fastScores.insert(fastScores.end(), probabilitiesOfWin[i].begin(), probabilitiesOfWin[i].end());
+            exactScores.insert(exactScores.end(), exactProbabilitiesOfWin[i].begin(), exactProbabilitiesOfWin[i].end());
+        }
+        validation->report(fastScores, exactScores);
+    }
+
+    for (int i = 0; i < generations.size(); i++) {
+        std::vector<std::pair<StrengthVector, double>> zipped;
+        zip(generations[i], probabilitiesOfWin[i], zipped);
+
+        std::sort(zipped.begin(), zipped.end(),
+                  [&](const auto& a, const auto& b) {
+                      return a.second > b.second;
+                  });
+
+        unzip(zipped, generations[i], probabilitiesOfWin[i]);
+    }
+
+    return probabilitiesOfWin;
+}
+
+std::vector<std::vector<double>> Simulation::tournamentProbabilities(const std::vector<std::vector<StrengthVector>>& generations,
+                                                                     const int threadsNumber,
+                                                                     const SimulationOptions& options,
+                                                                     double& maxDroppedMass) {
+    /*
+     * Средние вероятности победы каждой команды всех популяций в турнирах.
+     *
+     * Перебираются все наборы команд (по одной из каждой популяции),
+     * наборы делятся на `threadsNumber` непрерывных отрезков, каждый отрезок
+     * накапливает свои частичные суммы, которые затем складываются по порядку.
+     * Способ оценки турнира выбирается по `options.tournamentBackend`:
+     * при слишком большой таблице состояний вместо плотной используется
+     * моделирование или разреженная оценка, для последней в `maxDroppedMass`
+     * накапливается наибольшая отброшенная ею масса.
+     * Плотная оценка при `Precision::Float` ведётся в float.
+     */
     auto probabilitiesOfWin = std::vector<std::vector<double>>(generations.size());
     auto dimensionalGeneric = std::vector<int>(generations.size());
+    long long tournamentsNumber = 1;
 
     for (int i = 0; i < generations.size(); i++) {
         probabilitiesOfWin[i] = std::vector<double>(generations[i].size());
         dimensionalGeneric[i] = generations[i].size();
+        tournamentsNumber *= generations[i].size();
         for (int j = 0; j < generations[i].size(); j++) {
             probabilitiesOfWin[i][j] = 0;
         }
     }
-    auto multiIndexGeneric = MultiIndexGeneric(dimensionalGeneric);
-    auto futures = std::vector<std::future<int>>((unsigned long) threadsNumber);
-
-    auto calculateProbabilitiesWin = [&probabilitiesOfWin, &generations](const std::vector<int>& k) {
-        auto teams = std::vector<StrengthVector>(generations.size());
-        for (int i = 0; i < generations.size(); i++) {
-            teams[i] = generations[i][k[i]];
-        }
-
-        auto probabilities = QualityEstimation::probabilitiesOfWin(teams);
-        for (int i = 0; i < generations.size(); i++) {
-            probabilitiesOfWin[i][k[i]] += probabilities[i];
-        }
-        return 0;
-    };
 
-    int currentFutures = 0;
-    while (true) {
-        auto k = multiIndexGeneric.getIndex();
-        futures[currentFutures++] = std::async(std::launch::async, calculateProbabilitiesWin, k);
-        auto isContinue = multiIndexGeneric.next();
+    auto chunksNumber = (int) std::min<long long>(threadsNumber, tournamentsNumber);
+    auto partialProbabilitiesOfWin = std::vector<std::vector<std::vector<double>>>(chunksNumber, probabilitiesOfWin);
+    auto partialDroppedMasses = std::vector<double>(chunksNumber, 0.0);
+    auto tournamentTeams = std::vector<StrengthVector>(generations.size());
+    for (int i = 0; i < generations.size(); i++) {
+        tournamentTeams[i] = generations[i][0];
+    }
+    auto backend = tournamentBackend(tournamentTeams, options);
+    auto monteCarlo = options.monteCarlo ? options.monteCarlo : std::make_shared<MonteCarloEstimation>();
+    auto isFloat = (options.selectionPrecision == Precision::Float);
+
+    parallelFor(chunksNumber, chunksNumber, [&partialProbabilitiesOfWin, &partialDroppedMasses, &generations,
+                                             &dimensionalGeneric, &options, &monteCarlo, backend, isFloat,
+                                             tournamentsNumber, chunksNumber](const int chunk) {
+        auto begin = tournamentsNumber * chunk / chunksNumber;
+        auto end = tournamentsNumber * (chunk + 1) / chunksNumber;
+        auto multiIndexGeneric = MultiIndexGeneric(dimensionalGeneric);
+        multiIndexGeneric.setLinearIndex(begin);
+
+        auto teams = std::vector<RunLengthTeam>(generations.size());
+        auto currentTeams = std::vector<StrengthVector>(generations.size());
+        auto probabilities = std::vector<double>(generations.size());
+        auto& partialProbabilities = partialProbabilitiesOfWin[chunk];
+
+        for (auto tournament = begin; tournament < end; tournament++) {
+            auto& k = multiIndexGeneric.getIndex();
+            if (backend == TournamentBackend::Sparse) {
+                for (int i = 0; i < generations.size(); i++) {
+                    currentTeams[i] = generations[i][k[i]];
+                }
+                auto sparseProbabilities = QualityEstimation::probabilitiesOfWinSparse(currentTeams,
+                                                                                       options.sparseEpsilon,
+                                                                                       options.denseStatesLimit);
+                probabilities = sparseProbabilities.probabilities;
+                partialDroppedMasses[chunk] = std::max(partialDroppedMasses[chunk], sparseProbabilities.droppedMass);
+            } else if (backend == TournamentBackend::MonteCarlo) {
+                for (int i = 0; i < generations.size(); i++) {
+                    currentTeams[i] = generations[i][k[i]];
+                }
+                probabilities = monteCarlo->probabilitiesOfWin(currentTeams).probabilities;
+            } else {
+                for (int i = 0; i < generations.size(); i++) {
+                    teams[i] = RunLengthTeam(generations[i][k[i]]);
+                }
+                probabilities = isFloat ? QualityEstimation::probabilitiesOfWin<float>(teams)
+                                        : QualityEstimation::probabilitiesOfWin(teams);
+            }
 
-        if ((currentFutures == threadsNumber) || (!isContinue)) {
-            for (int i = 0; i < currentFutures; i++) {
-                futures[i].get();
+            for (int i = 0; i < generations.size(); i++) {
+                partialProbabilities[i][k[i]] += probabilities[i];
             }
-            currentFutures = 0;
+            multiIndexGeneric.next();
         }
+    });
 
-        if (!isContinue) {
-            break;
+    for (int chunk = 0; chunk < chunksNumber; chunk++) {
+        maxDroppedMass = std::max(maxDroppedMass, partialDroppedMasses[chunk]);
+        for (int i = 0; i < generations.size(); i++) {
+            for (int j = 0; j < generations[i].size(); j++) {
+                probabilitiesOfWin[i][j] += partialProbabilitiesOfWin[chunk][i][j];
+            }
         }
     }
 
@@ -304,17 +911,13 @@ std::vector<std::vector<double>> Simulation::selectSomeTeams(std::vector<std::ve
         }
     }
 
-    for (int i = 0; i < generations.size(); i++) {
-        std::vector<std::pair<StrengthVector, double>> zipped;
-        zip(generations[i], probabilitiesOfWin[i], zipped);
-
-        std::sort(zipped.begin(), zipped.end(),
-                  [&](const auto& a, const auto& b) {
-                      return a.second > b.second;
-                  });
-
-        unzip(zipped, generations[i], probabilitiesOfWin[i]);
-    }
-
     return probabilitiesOfWin;
 }
+
+SimulationOptions Simulation::rescoringOptions(const SimulationOptions& options) {
+    /* Настройки для итоговой оценки: double и без предварительного отбора. */
+    auto result = options;
+    result.selectionPrecision = Precision::Double;
+    result.screening = nullptr;
+    return result;
+}
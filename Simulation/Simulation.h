@@ -12,6 +12,9 @@
 #include <random>
 #include "../Gladiator/StrengthVector.h"
 #include "QualityEstimation.h"
+#include "SimulationOptions.h"
+#include "Checkpoint.h"
+#include "Executor.h"
 
 class Simulation {
 public:
@@ -21,32 +24,126 @@ public:
                                                            int generationNumber=10,
                                                            int epochs=10,
                                                            double mutationCoefficient=0.5,
-                                                           int threadsNumber=3);
+                                                           int threadsNumber=3,
+                                                           const SimulationOptions& options=SimulationOptions());
+    static StrengthVector simulationForOneTeamWithEnemies(double totalStrength,
+                                                          int gladiatorNumber,
+                                                          const EnemyEnsemble& enemies,
+                                                          int generationNumber=10,
+                                                          int epochs=10,
+                                                          double mutationCoefficient=0.5,
+                                                          int threadsNumber=3,
+                                                          const SimulationOptions& options=SimulationOptions());
+    static std::vector<StrengthVector> simulationForOneTeamWithFitness(double totalStrength,
+                                                                       int gladiatorNumber,
+                                                                       const std::function<double(const StrengthVector&)>& fitness,
+                                                                       const std::vector<StrengthVector>& seeds,
+                                                                       int generationNumber=10,
+                                                                       int epochs=10,
+                                                                       double mutationCoefficient=0.5,
+                                                                       int threadsNumber=3,
+                                                                       const SimulationOptions& options=SimulationOptions());
     static std::vector<StrengthVector> simulationTeams(std::vector<double> totalStrengths,
                                                        std::vector<int> gladiatorNumbers,
                                                        int generationNumber=10,
                                                        int epochs=10,
                                                        double mutationCoefficient=0.5,
-                                                       int threadsNumber=3);
+                                                       int threadsNumber=3,
+                                                       const SimulationOptions& options=SimulationOptions());
+    static StrengthVector resumeOneTeamWithOneEnemy(const std::string& checkpointPath,
+                                                    int threadsNumber=3,
+                                                    const SimulationOptions& options=SimulationOptions());
+    static std::vector<StrengthVector> resumeTeams(const std::string& checkpointPath,
+                                                   int threadsNumber=3,
+                                                   const SimulationOptions& options=SimulationOptions());
+    static TournamentBackend tournamentBackend(const std::vector<StrengthVector>& teams, const SimulationOptions& options);
 private:
+    // Случайные числа для построения нового поколения (см. `drawVariation`).
+    struct Variation {
+        int selectedNumber{0};
+        std::vector<int> firstIndices;
+        std::vector<int> secondIndices;
+        std::vector<double> alphas;
+    };
+
+    static StrengthVector solveOneTeamWithOneEnemy(CheckpointState state,
+                                                   int threadsNumber,
+                                                   const SimulationOptions& options);
+    static std::vector<StrengthVector> evolveTeams(CheckpointState state,
+                                                   int threadsNumber,
+                                                   const SimulationOptions& options);
+    static CheckpointState initialState(CheckpointKind kind,
+                                        const std::vector<double>& totalStrengths,
+                                        const std::vector<int>& gladiatorNumbers,
+                                        int generationNumber,
+                                        int epochs,
+                                        double mutationCoefficient,
+                                        int threadsNumber,
+                                        const std::vector<std::vector<StrengthVector>>& seeds);
+    static std::vector<StrengthVector> evolveOneTeam(CheckpointState state,
+                                                     int threadsNumber,
+                                                     const std::function<std::vector<double>(std::vector<StrengthVector>&)>& select,
+                                                     const SimulationOptions& options);
+    static std::vector<StrengthVector> breed(const std::vector<StrengthVector>& generation,
+                                             int selectedNumber,
+                                             std::mt19937& randomGenerator,
+                                             int threadsNumber,
+                                             const SimulationOptions& options);
+    static std::vector<std::vector<StrengthVector>> breedTeams(const std::vector<std::vector<StrengthVector>>& generations,
+                                                               int selectedNumber,
+                                                               std::mt19937& randomGenerator,
+                                                               int threadsNumber,
+                                                               const SimulationOptions& options);
+    static Variation drawVariation(int generationSize,
+                                   int gladiatorNumber,
+                                   int selectedNumber,
+                                   std::mt19937& randomGenerator);
+    static StrengthVector offspring(const std::vector<StrengthVector>& generation, const Variation& variation, int i);
+    static void deduplicate(std::vector<StrengthVector>& generation,
+                            std::mt19937& randomGenerator,
+                            int threadsNumber,
+                            const SimulationOptions& options);
+    static void reportProgress(const SimulationOptions& options, const CheckpointState& state);
+    static std::unique_ptr<CheckpointWriter> checkpointWriter(const SimulationOptions& options);
+    static void submitCheckpoint(CheckpointWriter& writer,
+                                 const CheckpointState& state,
+                                 std::vector<std::vector<StrengthVector>> generations,
+                                 std::vector<std::vector<double>> scores,
+                                 const std::mt19937& randomGenerator);
     static std::vector<StrengthVector> initialize(double totalStrength,
                                                   int gladiatorNumber,
                                                   int generationNumber,
                                                   std::default_random_engine randomGenerator,
                                                   int threadsNumber);
-    static void selectOneTeam(std::vector<StrengthVector>& generation,
-                              const StrengthVector& enemy,
-                              int threadsNumber);
-    static std::vector<StrengthVector> crossbreed(std::vector<StrengthVector> generation,
-                                                  int crossbredGenerationNumber,
-                                                  std::mt19937 randomGenerator,
-                                                  int threadsNumber);
-    static std::vector<StrengthVector> mutate(std::vector<StrengthVector> generation,
-                                              std::mt19937 randomGenerator,
-                                              int threadsNumber);
+    static std::vector<double> selectOneTeam(std::vector<StrengthVector>& generation,
+                                             const StrengthVector& enemy,
+                                             const PreparedOpponent& opponent,
+                                             int threadsNumber,
+                                             const SimulationOptions& options);
+    static std::vector<double> selectByFitness(std::vector<StrengthVector>& generation,
+                                               const std::function<double(const StrengthVector&)>& exactFitness,
+                                               const std::function<double(const StrengthVector&)>& surrogateFitness,
+                                               SurrogateScreening* screening,
+                                               const std::function<double(const StrengthVector&)>& referenceFitness,
+                                               PrecisionValidation* validation,
+                                               int threadsNumber,
+                                               const std::function<std::vector<double>(const std::vector<StrengthVector>&, int)>&
+                                                       exactBatchFitness=nullptr);
 
     static std::vector<std::vector<double>> selectSomeTeams(std::vector<std::vector<StrengthVector>> &generations,
-                                                            int threadsNumber);
+                                                            int threadsNumber,
+                                                            const SimulationOptions& options,
+                                                            double& maxDroppedMass);
+    static std::vector<std::vector<double>> tournamentProbabilities(const std::vector<std::vector<StrengthVector>>& generations,
+                                                                    int threadsNumber,
+                                                                    const SimulationOptions& options,
+                                                                    double& maxDroppedMass);
+    static SimulationOptions rescoringOptions(const SimulationOptions& options);
+
+    static double fitness(const StrengthVector& team, const StrengthVector& enemy, const SimulationOptions& options);
+    static double fitness(const StrengthVector& team, const EnemyEnsemble& enemies, const SimulationOptions& options);
+    static void parallelFor(int count, int threadsNumber, const std::function<void(int)>& body);
+    static void sortByScores(std::vector<StrengthVector>& generation, std::vector<double>& scores, int count);
 };
 
 
@@ -0,0 +1,82 @@
+#ifndef GLADIATORSIMULATION_SIMULATIONOPTIONS_H
+#define GLADIATORSIMULATION_SIMULATIONOPTIONS_H
+
+
+#include <memory>
+#include <string>
+#include "SurrogateScreening.h"
+#include "MonteCarloEstimation.h"
+#include "../Gladiator/EnemyEnsemble.h"
+#include "../Gladiator/PreparedOpponent.h"
+#include "SolutionStore.h"
+#include "PrecisionValidation.h"
+#include "JobControl.h"
+
+enum class TournamentBackend {
+    // Точная плотная оценка, если таблица состояний не больше `denseStatesLimit`,
+    // иначе моделирование (если задано `monteCarlo`) или разреженная оценка.
+    Automatic,
+    Dense,
+    Sparse,
+    MonteCarlo
+};
+
+enum class Objective {
+    WinProbability,
+    // Математическое ожидание числа выживших гладиаторов своей команды.
+    ExpectedSurvivors
+};
+
+enum class Precision {
+    Double,
+    // Отбор по вероятностям победы в float; итоговые вероятности пересчитываются в double.
+    Float
+};
+
+struct SimulationOptions {
+    // Печатать ли лучшие команды и статистику по окончании расчёта.
+    bool verbose{true};
+    Objective objective{Objective::WinProbability};
+    // Свёртка целевой функции по набору противников в `simulationForOneTeamWithEnemies`.
+    EnsembleAggregation ensembleAggregation{EnsembleAggregation::WeightedAverage};
+    // Предварительный отбор потомков дешёвой оценкой перед точной, nullptr -- отбор отключён.
+    std::shared_ptr<SurrogateScreening> screening{nullptr};
+    // Порог отбрасывания состояний в разреженной оценке турниров, 0 -- без отбрасывания.
+    double sparseEpsilon{0};
+    // Турниры с большим числом состояний всегда оцениваются разреженным алгоритмом,
+    // фронт которого тоже не больше `denseStatesLimit` состояний (лишние отбрасываются).
+    long long denseStatesLimit{1LL << 22};
+    TournamentBackend tournamentBackend{TournamentBackend::Automatic};
+    std::shared_ptr<MonteCarloEstimation> monteCarlo{nullptr};
+    // Хранилище решённых сценариев: начальное поколение дополняется решениями
+    // `warmStartNeighbours` ближайших сценариев, а найденное решение сохраняется.
+    std::shared_ptr<SolutionStore> solutionStore{nullptr};
+    int warmStartNeighbours{5};
+    // Контрольные точки для simulationForOneTeamWithOneEnemy и simulationTeams:
+    // раз в `checkpointPeriod` (> 0) эпох состояние записывается в `checkpointPath` (пустой -- не записывается).
+    std::string checkpointPath;
+    int checkpointPeriod{10};
+    // Точность оценок при отборе; для `Objective::ExpectedSurvivors` всегда double.
+    Precision selectionPrecision{Precision::Double};
+    // Подготовленный противник для `simulationForOneTeamWithOneEnemy`; используется, если
+    // совпадает с противником запуска, иначе противник подготавливается заново на запуск.
+    std::shared_ptr<const PreparedOpponent> preparedOpponent{nullptr};
+    // Приведение команд каждого нового поколения к каноническому виду (силы по убыванию)
+    // и замена повторов случайными командами той же суммарной силы. Повторы -- команды
+    // с равными силами, округлёнными до `deduplicationTolerance` (0 -- точное совпадение).
+    // Для `Objective::ExpectedSurvivors` порядок гладиаторов важен, и команды не упорядочиваются.
+    // По умолчанию выключено: поиск идёт так же, как до появления этой настройки.
+    bool deduplication{false};
+    double deduplicationTolerance{0};
+    // Оценка поколения против одного противника пакетным ядром поединков
+    // (только для `Objective::WinProbability` в double; против противника из серий
+    // команды считаются по одной ядром серий).
+    bool batchedSelection{false};
+    // Периодическое сравнение отбора в float с отбором в double, nullptr -- без сравнения.
+    std::shared_ptr<PrecisionValidation> precisionValidation{nullptr};
+    // Отмена и ход выполнения расчёта, nullptr -- без них.
+    std::shared_ptr<JobControl> jobControl{nullptr};
+};
+
+
+#endif //GLADIATORSIMULATION_SIMULATIONOPTIONS_H
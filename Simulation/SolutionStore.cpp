@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SolutionStore.h"
+#include "SimulationOptions.h"
+
+SolutionStore::SolutionStore(std::string path) {
+    /**
+     * Хранилище решённых сценариев в файле `path`, читаемом через mmap.
+     *
+     * Файл начинается с заголовка (магическое число, версия), затем идут записи:
+     *     RecordHeader, суммарные силы команд [teamsNumber], числа гладиаторов [teamsNumber],
+     *     контекст [contextLength], силы гладиаторов решений подряд.
+     * Контекст задачи одной команды -- профиль противника [profileLength] (см. `profile`),
+     * суммарная сила противника и его силы; профиль считается один раз при записи.
+     * Все поля -- 8-байтовые, поэтому записи выровнены и читаются прямо из отображения.
+     * Новые записи дописываются в конец одним вызовом `write`.
+     */
+    this->path = std::move(path);
+    descriptor = open(this->path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (descriptor < 0) {
+        std::cout << "Cannot open solution store: " << this->path << std::endl;
+        exit(-1);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    struct stat status{};
+    fstat(descriptor, &status);
+    if (status.st_size == 0) {
+        uint64_t header[2] = {magic, version};
+        if (write(descriptor, header, sizeof(header)) != sizeof(header)) {
+            std::cout << "Cannot write solution store: " << this->path << std::endl;
+            exit(-1);
+        }
+    }
+    remap();
+
+    auto header = reinterpret_cast<const uint64_t*>(mapping);
+    if ((mappingSize < 2 * sizeof(uint64_t)) || (header[0] != magic) || (header[1] != version)) {
+        std::cout << "Wrong solution store format: " << this->path << std::endl;
+        exit(-1);
+    }
+}
+
+SolutionStore::~SolutionStore() {
+    unmap();
+    if (descriptor >= 0) {
+        close(descriptor);
+    }
+}
+
+void SolutionStore::unmap() {
+    if (mapping != nullptr) {
+        munmap(const_cast<char*>(mapping), mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+}
+
+void SolutionStore::remap() {
+    struct stat status{};
+    fstat(descriptor, &status);
+    if ((mapping != nullptr) && (status.st_size == mappingSize)) {
+        return;
+    }
+
+    unmap();
+    auto address = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    if (address == MAP_FAILED) {
+        std::cout << "Cannot map solution store: " << path << std::endl;
+        exit(-1);
+    }
+    mapping = static_cast<const char*>(address);
+    mappingSize = status.st_size;
+}
+
+template <typename Visitor>
+void SolutionStore::forEachRecord(const uint64_t kind, Visitor visitor) {
+    remap();
+    size_t offset = 2 * sizeof(uint64_t);
+    while (offset + sizeof(RecordHeader) <= mappingSize) {
+        auto header = reinterpret_cast<const RecordHeader*>(mapping + offset);
+        if ((header->size < sizeof(RecordHeader)) || (offset + header->size > mappingSize)) {
+            break;
+        }
+        if (header->kind == kind) {
+            auto fields = reinterpret_cast<const double*>(mapping + offset + sizeof(RecordHeader));
+            visitor(*header, fields);
+        }
+        offset += header->size;
+    }
+}
+
+void SolutionStore::append(const uint64_t kind,
+                           const Objective objective,
+                           const std::vector<double>& totals,
+                           const std::vector<int>& gladiators,
+                           const std::vector<double>& context,
+                           const std::vector<StrengthVector>& solutions,
+                           const double quality) {
+    auto fields = std::vector<double>(totals.begin(), totals.end());
+    fields.insert(fields.end(), gladiators.begin(), gladiators.end());
+    fields.insert(fields.end(), context.begin(), context.end());
+    for (auto& solution: solutions) {
+        for (int i = 0; i < solution.getLength(); i++) {
+            fields.push_back(solution[i]);
+        }
+    }
+
+    auto header = RecordHeader{sizeof(RecordHeader) + fields.size() * sizeof(double),
+                               kind, (uint64_t) objective, totals.size(), context.size(), quality};
+    auto record = std::vector<char>(header.size);
+    std::memcpy(record.data(), &header, sizeof(header));
+    std::memcpy(record.data() + sizeof(header), fields.data(), fields.size() * sizeof(double));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (write(descriptor, record.data(), record.size()) != (ssize_t) record.size()) {
+        std::cout << "Cannot write solution store: " << path << std::endl;
+        exit(-1);
+    }
+}
+
+void SolutionStore::storeOneTeam(const double totalStrength,
+                                 const StrengthVector& enemy,
+                                 const StrengthVector& solution,
+                                 const double quality,
+                                 const Objective objective) {
+    auto context = profile(enemy.getData(), enemy.getLength());
+    context.push_back(std::accumulate(enemy.getData(), enemy.getData() + enemy.getLength(), 0.0));
+    context.insert(context.end(), enemy.getData(), enemy.getData() + enemy.getLength());
+    append(oneTeamKind, objective, {totalStrength}, {solution.getLength()}, context, {solution}, quality);
+}
+
+void SolutionStore::storeTeams(const std::vector<StrengthVector>& solutions, const double quality) {
+    auto totals = std::vector<double>(solutions.size());
+    auto gladiators = std::vector<int>(solutions.size());
+    for (int j = 0; j < solutions.size(); j++) {
+        totals[j] = 0;
+        for (int i = 0; i < solutions[j].getLength(); i++) {
+            totals[j] += solutions[j][i];
+        }
+        gladiators[j] = solutions[j].getLength();
+    }
+    append(teamsKind, Objective::WinProbability, totals, gladiators, {}, solutions, quality);
+}
+
+std::vector<double> SolutionStore::profile(const double* strengths, const int length) {
+    /*
+     * Профиль противника: отсортированные доли суммарной силы,
+     * приведённые кусочно-линейной интерполяцией к `profileLength` точкам,
+     * чтобы сравнивать противников разной длины.
+     */
+    auto sorted = std::vector<double>(strengths, strengths + length);
+    std::sort(sorted.begin(), sorted.end());
+    auto total = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+
+    auto result = std::vector<double>(profileLength);
+    for (int q = 0; q < profileLength; q++) {
+        auto position = (length - 1) * q / (double) (profileLength - 1);
+        auto lower = (int) std::floor(position);
+        auto upper = std::min(lower + 1, length - 1);
+        auto weight = position - lower;
+        result[q] = length * ((1 - weight) * sorted[lower] + weight * sorted[upper]) / total;
+    }
+    return result;
+}
+
+std::vector<StrengthVector> SolutionStore::nearestOneTeam(const double totalStrength,
+                                                          const int gladiatorNumber,
+                                                          const StrengthVector& enemy,
+                                                          const Objective objective,
+                                                          const int neighboursNumber) {
+    /**
+     * Решения `neighboursNumber` ближайших сценариев с тем же числом гладиаторов
+     * и той же целевой функцией, масштабированные к суммарной силе `totalStrength`.
+     *
+     * Сценарий описывается логарифмом отношения суммарных сил,
+     * логарифмом длины противника и профилем противника (см. `profile`).
+     */
+    auto enemyTotal = std::accumulate(enemy.getData(), enemy.getData() + enemy.getLength(), 0.0);
+    auto enemyProfile = profile(enemy.getData(), enemy.getLength());
+    auto candidates = std::vector<std::pair<double, StrengthVector>>();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    forEachRecord(oneTeamKind, [&](const RecordHeader& header, const double* fields) {
+        auto recordTotal = fields[0];
+        auto recordGladiators = (int) fields[1];
+        auto recordProfile = fields + 2;
+        auto recordEnemyTotal = recordProfile[profileLength];
+        int recordEnemyLength = (int) header.contextLength - profileLength - 1;
+        if ((recordGladiators != gladiatorNumber) || (header.objective != (uint64_t) objective)
+            || (recordEnemyLength <= 0)) {
+            return;
+        }
+
+        auto distance = std::pow(std::log(totalStrength / enemyTotal) - std::log(recordTotal / recordEnemyTotal), 2)
+                        + std::pow(std::log((double) enemy.getLength() / recordEnemyLength), 2);
+        for (int q = 0; q < profileLength; q++) {
+            distance += std::pow(enemyProfile[q] - recordProfile[q], 2);
+        }
+        auto context = fields + 2;
+        int contextLength = header.contextLength;
+
+        auto solution = StrengthVector(gladiatorNumber);
+        for (int i = 0; i < gladiatorNumber; i++) {
+            solution[i] = context[contextLength + i] * totalStrength / recordTotal;
+        }
+        candidates.emplace_back(distance, solution);
+    });
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    auto result = std::vector<StrengthVector>();
+    for (int i = 0; i < std::min<int>(neighboursNumber, candidates.size()); i++) {
+        result.push_back(candidates[i].second);
+    }
+    return result;
+}
+
+std::vector<std::vector<StrengthVector>> SolutionStore::nearestTeams(const std::vector<double>& totalStrengths,
+                                                                     const std::vector<int>& gladiatorNumbers,
+                                                                     const int neighboursNumber) {
+    /**
+     * Решения ближайших сценариев нескольких команд с теми же числами гладиаторов.
+     * Сценарий описывается логарифмами долей команд в общей сумме сил.
+     */
+    int teamsNumber = totalStrengths.size();
+    auto sum = std::accumulate(totalStrengths.begin(), totalStrengths.end(), 0.0);
+    auto candidates = std::vector<std::pair<double, std::vector<StrengthVector>>>();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    forEachRecord(teamsKind, [&](const RecordHeader& header, const double* fields) {
+        if (header.teamsNumber != teamsNumber) {
+            return;
+        }
+        auto recordTotals = fields;
+        auto recordGladiators = fields + teamsNumber;
+        for (int j = 0; j < teamsNumber; j++) {
+            if ((int) recordGladiators[j] != gladiatorNumbers[j]) {
+                return;
+            }
+        }
+
+        auto recordSum = std::accumulate(recordTotals, recordTotals + teamsNumber, 0.0);
+        double distance = 0;
+        for (int j = 0; j < teamsNumber; j++) {
+            distance += std::pow(std::log(totalStrengths[j] / sum) - std::log(recordTotals[j] / recordSum), 2);
+        }
+
+        auto solutions = std::vector<StrengthVector>(teamsNumber);
+        auto strengths = fields + 2 * teamsNumber + header.contextLength;
+        for (int j = 0; j < teamsNumber; j++) {
+            solutions[j] = StrengthVector(gladiatorNumbers[j]);
+            for (int i = 0; i < gladiatorNumbers[j]; i++) {
+                solutions[j][i] = (*strengths++) * totalStrengths[j] / recordTotals[j];
+            }
+        }
+        candidates.emplace_back(distance, solutions);
+    });
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    auto result = std::vector<std::vector<StrengthVector>>();
+    for (int i = 0; i < std::min<int>(neighboursNumber, candidates.size()); i++) {
+        result.push_back(candidates[i].second);
+    }
+    return result;
+}
+
+long long SolutionStore::getRecordsNumber() {
+    long long result = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto kind: {oneTeamKind, teamsKind}) {
+        forEachRecord(kind, [&result](const RecordHeader&, const double*) {
+            result++;
+        });
+    }
+    return result;
+}
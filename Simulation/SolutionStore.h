@@ -0,0 +1,62 @@
+#ifndef GLADIATORSIMULATION_SOLUTIONSTORE_H
+#define GLADIATORSIMULATION_SOLUTIONSTORE_H
+
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "../Gladiator/StrengthVector.h"
+
+// Определено в SimulationOptions.h.
+enum class Objective;
+
+class SolutionStore {
+public:
+    explicit SolutionStore(std::string path);
+    ~SolutionStore();
+    SolutionStore(const SolutionStore&) = delete;
+    SolutionStore& operator=(const SolutionStore&) = delete;
+
+    void storeOneTeam(double totalStrength, const StrengthVector& enemy, const StrengthVector& solution,
+                      double quality, Objective objective);
+    void storeTeams(const std::vector<StrengthVector>& solutions, double quality);
+    std::vector<StrengthVector> nearestOneTeam(double totalStrength, int gladiatorNumber,
+                                               const StrengthVector& enemy, Objective objective,
+                                               int neighboursNumber);
+    std::vector<std::vector<StrengthVector>> nearestTeams(const std::vector<double>& totalStrengths,
+                                                          const std::vector<int>& gladiatorNumbers,
+                                                          int neighboursNumber);
+    long long getRecordsNumber();
+private:
+    static constexpr uint64_t magic = 0x314c4f5353414c47ULL;
+    static constexpr uint64_t version = 2;
+    static constexpr uint64_t oneTeamKind = 0;
+    static constexpr uint64_t teamsKind = 1;
+    static constexpr int profileLength = 8;
+
+    struct RecordHeader {
+        uint64_t size;
+        uint64_t kind;
+        uint64_t objective;
+        uint64_t teamsNumber;
+        uint64_t contextLength;
+        double quality;
+    };
+
+    std::string path;
+    std::mutex mutex;
+    int descriptor{-1};
+    const char* mapping{nullptr};
+    size_t mappingSize{0};
+
+    void append(uint64_t kind, Objective objective, const std::vector<double>& totals, const std::vector<int>& gladiators,
+                const std::vector<double>& context, const std::vector<StrengthVector>& solutions, double quality);
+    void remap();
+    void unmap();
+    template <typename Visitor>
+    void forEachRecord(uint64_t kind, Visitor visitor);
+    static std::vector<double> profile(const double* strengths, int length);
+};
+
+
+#endif //GLADIATORSIMULATION_SOLUTIONSTORE_H
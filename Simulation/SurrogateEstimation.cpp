@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <numeric>
+#include "SurrogateEstimation.h"
+
+void SurrogateEstimation::moments(const StrengthVector& team, double& mean, double& variance) {
+    mean = 0;
+    variance = 0;
+    for (int i = 0; i < team.getLength(); i++) {
+        mean += team[i];
+        variance += team[i] * team[i];
+    }
+}
+
+double SurrogateEstimation::probabilityOfWinLeftTeam(const StrengthVector& leftTeam, const StrengthVector& rightTeam) {
+    /**
+     * Приближённая вероятность победы первой команды.
+     *
+     * Точное значение равно P(A_m > B_n), где A_m := \sum_{j=1}^m a_j X_j, B_n := \sum_{i=1}^n b_i Y_i.
+     * Заменим A_m и B_n гамма-распределёнными величинами с теми же
+     * математическими ожиданиями и дисперсиями: k = E^2 / D, theta = D / E.
+     * Если U ~ Gamma(k_A, 1), V ~ Gamma(k_B, 1), то U / (U + V) ~ Beta(k_A, k_B), поэтому
+     *     P(theta_A U > theta_B V) = 1 - I_{theta_B / (theta_A + theta_B)}(k_A, k_B).
+     * Для команд из одного гладиатора приближение точное, стоимость -- O(m + n).
+     */
+    double leftMean, leftVariance, rightMean, rightVariance;
+    moments(leftTeam, leftMean, leftVariance);
+    moments(rightTeam, rightMean, rightVariance);
+
+    auto leftShape = leftMean * leftMean / leftVariance;
+    auto leftScale = leftVariance / leftMean;
+    auto rightShape = rightMean * rightMean / rightVariance;
+    auto rightScale = rightVariance / rightMean;
+
+    return 1 - regularizedIncompleteBeta(rightScale / (leftScale + rightScale), leftShape, rightShape);
+}
+
+double SurrogateEstimation::probabilityOfWinLeftTeamNormal(const StrengthVector& leftTeam, const StrengthVector& rightTeam) {
+    /**
+     * Приближение разности A_m - B_n нормальным распределением с теми же моментами.
+     */
+    double leftMean, leftVariance, rightMean, rightVariance;
+    moments(leftTeam, leftMean, leftVariance);
+    moments(rightTeam, rightMean, rightVariance);
+
+    return 0.5 * std::erfc(-(leftMean - rightMean) / std::sqrt(2 * (leftVariance + rightVariance)));
+}
+
+double SurrogateEstimation::regularizedIncompleteBeta(const double x, const double a, const double b) {
+    if (x <= 0) {
+        return 0;
+    } else if (x >= 1) {
+        return 1;
+    }
+
+    /* std::lgamma пишет знак в глобальную `signgam`, а оценка идёт из нескольких потоков. */
+    int sign;
+    auto front = std::exp(lgamma_r(a + b, &sign) - lgamma_r(a, &sign) - lgamma_r(b, &sign)
+                          + a * std::log(x) + b * std::log(1 - x));
+    if (x < (a + 1) / (a + b + 2)) {
+        return front * betaContinuedFraction(x, a, b) / a;
+    } else {
+        return 1 - front * betaContinuedFraction(1 - x, b, a) / b;
+    }
+}
+
+double SurrogateEstimation::betaContinuedFraction(const double x, const double a, const double b) {
+    /*
+     * Непрерывная дробь для неполной бета-функции, вычисляемая методом Лентца.
+     */
+    const int maxIterations = 300;
+    const double epsilon = 1e-12;
+    const double tiny = 1e-300;
+
+    auto fixTiny = [tiny](double value) {
+        return (std::fabs(value) < tiny) ? tiny : value;
+    };
+
+    double c = 1;
+    double d = 1 / fixTiny(1 - (a + b) * x / (a + 1));
+    double result = d;
+
+    for (int m = 1; m <= maxIterations; m++) {
+        auto numerator = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+        d = 1 / fixTiny(1 + numerator * d);
+        c = fixTiny(1 + numerator / c);
+        result *= d * c;
+
+        numerator = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+        d = 1 / fixTiny(1 + numerator * d);
+        c = fixTiny(1 + numerator / c);
+        auto delta = d * c;
+        result *= delta;
+
+        if (std::fabs(delta - 1) < epsilon) {
+            break;
+        }
+    }
+    return result;
+}
+
+std::vector<double> SurrogateEstimation::ranks(const std::vector<double>& values) {
+    auto order = std::vector<int>(values.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&values](int i, int j) { return values[i] < values[j]; });
+
+    auto result = std::vector<double>(values.size());
+    for (int i = 0; i < order.size();) {
+        int j = i;
+        while ((j + 1 < order.size()) && (values[order[j + 1]] == values[order[i]])) {
+            j++;
+        }
+        for (int k = i; k <= j; k++) {
+            result[order[k]] = (i + j) / 2.0;
+        }
+        i = j + 1;
+    }
+    return result;
+}
+
+double SurrogateEstimation::rankCorrelation(const std::vector<double>& first, const std::vector<double>& second) {
+    /**
+     * Коэффициент ранговой корреляции Спирмена (с учётом совпадающих значений).
+     */
+    if ((first.size() != second.size()) || (first.size() < 2)) {
+        return 1;
+    }
+
+    auto firstRanks = ranks(first);
+    auto secondRanks = ranks(second);
+    auto mean = (first.size() - 1) / 2.0;
+    double covariance = 0, firstVariance = 0, secondVariance = 0;
+    for (int i = 0; i < first.size(); i++) {
+        covariance += (firstRanks[i] - mean) * (secondRanks[i] - mean);
+        firstVariance += (firstRanks[i] - mean) * (firstRanks[i] - mean);
+        secondVariance += (secondRanks[i] - mean) * (secondRanks[i] - mean);
+    }
+
+    if ((firstVariance == 0) || (secondVariance == 0)) {
+        return 1;
+    }
+    return covariance / std::sqrt(firstVariance * secondVariance);
+}
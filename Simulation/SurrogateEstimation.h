@@ -0,0 +1,21 @@
+#ifndef GLADIATORSIMULATION_SURROGATEESTIMATION_H
+#define GLADIATORSIMULATION_SURROGATEESTIMATION_H
+
+
+#include <cmath>
+#include "../Gladiator/StrengthVector.h"
+
+class SurrogateEstimation {
+public:
+    static double probabilityOfWinLeftTeam(const StrengthVector& leftTeam, const StrengthVector& rightTeam);
+    static double probabilityOfWinLeftTeamNormal(const StrengthVector& leftTeam, const StrengthVector& rightTeam);
+    static double rankCorrelation(const std::vector<double>& first, const std::vector<double>& second);
+private:
+    static void moments(const StrengthVector& team, double& mean, double& variance);
+    static double regularizedIncompleteBeta(double x, double a, double b);
+    static double betaContinuedFraction(double x, double a, double b);
+    static std::vector<double> ranks(const std::vector<double>& values);
+};
+
+
+#endif //GLADIATORSIMULATION_SURROGATEESTIMATION_H
@@ -0,0 +1,77 @@
+#include "SurrogateScreening.h"
+
+void SurrogateScreening::checkPassRatio(const double passRatio) {
+    if ((passRatio <= 0) || (passRatio > 1)) {
+        std::cout << "Wrong pass ratio: " << passRatio << std::endl;
+        exit(-1);
+    }
+}
+
+SurrogateScreening::SurrogateScreening(const double passRatio, const int auditPeriod, Estimator estimator) {
+    /**
+     * Этап предварительного отбора потомков по дешёвой оценке.
+     *
+     * Поколение упорядочивается по `estimator`, и только доля `passRatio`
+     * лучших по этой оценке команд получает точную оценку динамическим программированием.
+     * Каждый `auditPeriod`-й отбор (0 -- никогда) точно оцениваются все команды,
+     * чтобы измерить корреляцию рангов без смещения, вызванного отбором.
+     */
+    checkPassRatio(passRatio);
+    this->passRatio = passRatio;
+    this->auditPeriod = auditPeriod;
+    this->estimator = std::move(estimator);
+}
+
+double SurrogateScreening::estimate(const StrengthVector& leftTeam, const StrengthVector& rightTeam) const {
+    return estimator(leftTeam, rightTeam);
+}
+
+int SurrogateScreening::nextExactNumber(const int generationSize) {
+    screeningsNumber++;
+    isAudit = (auditPeriod > 0) && (screeningsNumber % auditPeriod == 0);
+    if (isAudit) {
+        return generationSize;
+    }
+    return std::max(1, std::min(generationSize, (int) std::ceil(generationSize * passRatio)));
+}
+
+void SurrogateScreening::report(const std::vector<double>& surrogateScores,
+                                const std::vector<double>& exactScores,
+                                const int generationSize) {
+    lastRankCorrelation = SurrogateEstimation::rankCorrelation(surrogateScores, exactScores);
+    exactEvaluations += exactScores.size();
+    skippedEvaluations += generationSize - (int) exactScores.size();
+    if (isAudit) {
+        auditRankCorrelationSum += lastRankCorrelation;
+        auditsNumber++;
+    }
+}
+
+double SurrogateScreening::getPassRatio() const {
+    return passRatio;
+}
+
+double SurrogateScreening::getLastRankCorrelation() const {
+    return lastRankCorrelation;
+}
+
+double SurrogateScreening::getAuditRankCorrelation() const {
+    return (auditsNumber > 0) ? auditRankCorrelationSum / auditsNumber : lastRankCorrelation;
+}
+
+long long SurrogateScreening::getExactEvaluations() const {
+    return exactEvaluations;
+}
+
+long long SurrogateScreening::getSkippedEvaluations() const {
+    return skippedEvaluations;
+}
+
+void SurrogateScreening::printStatistics() const {
+    std::cout << "Surrogate screening: pass ratio " << passRatio
+              << ", exact evaluations " << exactEvaluations
+              << ", skipped evaluations " << skippedEvaluations
+              << ", last rank correlation " << lastRankCorrelation
+              << ", audit rank correlation " << getAuditRankCorrelation()
+              << " (" << auditsNumber << " audits)" << std::endl;
+}
@@ -0,0 +1,41 @@
+#ifndef GLADIATORSIMULATION_SURROGATESCREENING_H
+#define GLADIATORSIMULATION_SURROGATESCREENING_H
+
+
+#include <functional>
+#include "SurrogateEstimation.h"
+
+class SurrogateScreening {
+public:
+    using Estimator = std::function<double(const StrengthVector&, const StrengthVector&)>;
+
+    explicit SurrogateScreening(double passRatio=0.25,
+                                int auditPeriod=10,
+                                Estimator estimator=SurrogateEstimation::probabilityOfWinLeftTeam);
+
+    double estimate(const StrengthVector& leftTeam, const StrengthVector& rightTeam) const;
+    int nextExactNumber(int generationSize);
+    void report(const std::vector<double>& surrogateScores, const std::vector<double>& exactScores, int generationSize);
+
+    double getPassRatio() const;
+    double getLastRankCorrelation() const;
+    double getAuditRankCorrelation() const;
+    long long getExactEvaluations() const;
+    long long getSkippedEvaluations() const;
+    void printStatistics() const;
+private:
+    double passRatio;
+    int auditPeriod;
+    Estimator estimator;
+    int screeningsNumber{0};
+    bool isAudit{false};
+    double lastRankCorrelation{1};
+    double auditRankCorrelationSum{0};
+    int auditsNumber{0};
+    long long exactEvaluations{0};
+    long long skippedEvaluations{0};
+    static void checkPassRatio(double passRatio);
+};
+
+
+#endif //GLADIATORSIMULATION_SURROGATESCREENING_H
@@ -0,0 +1,88 @@
+#include "TaskGraph.h"
+#include "Executor.h"
+
+int TaskGraph::addTask(std::function<void()> task, const std::vector<int>& dependencies) {
+    /* Зависимости -- номера ранее добавленных задач; задача начинается после их завершения. */
+    int node = nodes.size();
+    nodes.push_back(Node{std::move(task), {}, (int) dependencies.size()});
+    for (auto dependency: dependencies) {
+        nodes[dependency].dependents.push_back(node);
+    }
+    return node;
+}
+
+void TaskGraph::run(const int threadsNumber) {
+    /**
+     * Выполнение всех задач в `threadsNumber` потоков.
+     *
+     * Задача попадает в очередь готовых, как только завершены все её зависимости,
+     * поэтому независимые части графа не ждут друг друга на общих барьерах.
+     * Если поток привязан к общему `Executor`, рабочие циклы выполняются в его очереди.
+     * Если задача бросила исключение, новые задачи не начинаются, а после завершения
+     * уже начатых исключение первой такой задачи передаётся вызывающему.
+     */
+    completedNumber = 0;
+    failure = nullptr;
+    readyNodes.clear();
+    for (int node = 0; node < nodes.size(); node++) {
+        if (nodes[node].remainingDependencies == 0) {
+            readyNodes.push_back(node);
+        }
+    }
+
+    auto workersNumber = std::max(1, std::min<int>(threadsNumber, nodes.size()));
+    if (workersNumber == 1) {
+        work();
+    } else if (Executor::getCurrentExecutor() != nullptr) {
+        Executor::getCurrentExecutor()->parallelFor(Executor::getCurrentQueue(), workersNumber, workersNumber,
+                                                    [this](int) { work(); });
+    } else {
+        auto futures = std::vector<std::future<void>>(workersNumber - 1);
+        for (auto& future: futures) {
+            future = std::async(std::launch::async, &TaskGraph::work, this);
+        }
+        work();
+        for (auto& future: futures) {
+            future.get();
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+void TaskGraph::work() {
+    while (true) {
+        int node;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() {
+                return !readyNodes.empty() || (completedNumber == nodes.size()) || failure;
+            });
+            if (readyNodes.empty() || failure) {
+                return;
+            }
+            node = readyNodes.front();
+            readyNodes.pop_front();
+        }
+
+        auto taskFailure = std::exception_ptr();
+        try {
+            nodes[node].task();
+        } catch (...) {
+            taskFailure = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completedNumber++;
+        if (taskFailure && !failure) {
+            failure = taskFailure;
+        }
+        for (auto dependent: nodes[node].dependents) {
+            if (--nodes[dependent].remainingDependencies == 0) {
+                readyNodes.push_back(dependent);
+            }
+        }
+        condition.notify_all();
+    }
+}
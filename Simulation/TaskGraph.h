@@ -0,0 +1,34 @@
+#ifndef GLADIATORSIMULATION_TASKGRAPH_H
+#define GLADIATORSIMULATION_TASKGRAPH_H
+
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class TaskGraph {
+public:
+    int addTask(std::function<void()> task, const std::vector<int>& dependencies={});
+    void run(int threadsNumber);
+private:
+    struct Node {
+        std::function<void()> task;
+        std::vector<int> dependents;
+        int remainingDependencies{0};
+    };
+
+    std::vector<Node> nodes;
+    std::deque<int> readyNodes;
+    int completedNumber{0};
+    std::exception_ptr failure;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    void work();
+};
+
+
+#endif //GLADIATORSIMULATION_TASKGRAPH_H
@@ -0,0 +1,405 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "ScenarioSweep.h"
+
+double SweepJob::cost() const {
+    /*
+     * Грубая оценка числа операций динамического программирования за весь расчёт.
+     */
+    if (!isTeams) {
+        return (double) generationNumber * epochs * gladiatorNumber * enemy.getLength();
+    }
+
+    double tournaments = 1;
+    double states = gladiatorNumbers.size();
+    for (auto number: gladiatorNumbers) {
+        tournaments *= generationNumber;
+        states *= number + 1;
+    }
+    return tournaments * states * gladiatorNumbers.size() * epochs;
+}
+
+std::vector<std::string> ScenarioSweep::split(const std::string& text, const char separator) {
+    auto result = std::vector<std::string>();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, separator)) {
+        result.push_back(item);
+    }
+    return result;
+}
+
+double ScenarioSweep::parseDouble(const std::string& text, const int lineNumber) {
+    try {
+        size_t position;
+        auto value = std::stod(text, &position);
+        if (position == text.size()) {
+            return value;
+        }
+    } catch (const std::exception&) {
+    }
+    std::cout << "Wrong number \"" << text << "\" in scenario line " << lineNumber << std::endl;
+    exit(-1);
+}
+
+int ScenarioSweep::parseInt(const std::string& text, const int lineNumber) {
+    auto value = parseDouble(text, lineNumber);
+    if ((value != (int) value) || (value <= 0)) {
+        std::cout << "Wrong integer \"" << text << "\" in scenario line " << lineNumber << std::endl;
+        exit(-1);
+    }
+    return (int) value;
+}
+
+StrengthVector ScenarioSweep::parseEnemy(const std::string& text, const int lineNumber) {
+    /*
+     * Противник задаётся либо списком сил через запятую,
+     * либо как `суммарная сила/число гладиаторов` для одинаковых гладиаторов.
+     */
+    auto uniform = split(text, '/');
+    if (uniform.size() == 2) {
+        auto number = parseInt(uniform[1], lineNumber);
+        auto strength = parseDouble(uniform[0], lineNumber) / number;
+        auto enemy = StrengthVector(number);
+        for (int i = 0; i < number; i++) {
+            enemy[i] = strength;
+        }
+        return enemy;
+    }
+
+    auto strengths = split(text, ',');
+    auto enemy = StrengthVector(strengths.size());
+    for (int i = 0; i < strengths.size(); i++) {
+        enemy[i] = parseDouble(strengths[i], lineNumber);
+    }
+    return enemy;
+}
+
+SweepJob ScenarioSweep::parseJob(const std::string& kind,
+                                 const std::map<std::string, std::string>& values,
+                                 const int lineNumber) {
+    auto job = SweepJob();
+    job.isTeams = (kind == "teams");
+    job.key = kind;
+    for (auto& [name, value]: values) {
+        job.key += " " + name + "=" + value;
+    }
+
+    auto require = [&values, lineNumber](const std::string& name) -> const std::string& {
+        auto it = values.find(name);
+        if (it == values.end()) {
+            std::cout << "Missing \"" << name << "\" in scenario line " << lineNumber << std::endl;
+            exit(-1);
+        }
+        return it->second;
+    };
+
+    for (auto& [name, value]: values) {
+        if (name == "generation") {
+            job.generationNumber = parseInt(value, lineNumber);
+        } else if (name == "epochs") {
+            job.epochs = parseInt(value, lineNumber);
+        } else if (name == "mutation") {
+            job.mutationCoefficient = parseDouble(value, lineNumber);
+        } else if ((job.isTeams && (name != "strengths") && (name != "gladiators"))
+                   || (!job.isTeams && (name != "strength") && (name != "gladiators") && (name != "enemy"))) {
+            std::cout << "Unknown key \"" << name << "\" in scenario line " << lineNumber << std::endl;
+            exit(-1);
+        }
+    }
+
+    if (job.isTeams) {
+        for (auto& strength: split(require("strengths"), ',')) {
+            job.totalStrengths.push_back(parseDouble(strength, lineNumber));
+        }
+        for (auto& number: split(require("gladiators"), ',')) {
+            job.gladiatorNumbers.push_back(parseInt(number, lineNumber));
+        }
+        if (job.totalStrengths.size() != job.gladiatorNumbers.size()) {
+            std::cout << "Different numbers of strengths and gladiators in scenario line " << lineNumber << std::endl;
+            exit(-1);
+        }
+    } else {
+        job.totalStrength = parseDouble(require("strength"), lineNumber);
+        job.gladiatorNumber = parseInt(require("gladiators"), lineNumber);
+        job.enemy = parseEnemy(require("enemy"), lineNumber);
+    }
+    return job;
+}
+
+std::vector<SweepJob> ScenarioSweep::expandLine(const std::string& line, const int lineNumber) {
+    /*
+     * Строка сценария: `duel` или `teams`, затем пары `ключ=значение`.
+     * Значение может перечислять варианты через `|`,
+     * тогда строка задаёт все задачи декартова произведения вариантов.
+     */
+    std::stringstream stream(line);
+    std::string kind;
+    stream >> kind;
+    if ((kind != "duel") && (kind != "teams")) {
+        std::cout << "Unknown job kind \"" << kind << "\" in scenario line " << lineNumber << std::endl;
+        exit(-1);
+    }
+
+    auto names = std::vector<std::string>();
+    auto alternatives = std::vector<std::vector<std::string>>();
+    std::string token;
+    while (stream >> token) {
+        auto position = token.find('=');
+        if ((position == std::string::npos) || (position == 0) || (position + 1 == token.size())) {
+            std::cout << "Wrong token \"" << token << "\" in scenario line " << lineNumber << std::endl;
+            exit(-1);
+        }
+        names.push_back(token.substr(0, position));
+        alternatives.push_back(split(token.substr(position + 1), '|'));
+    }
+
+    auto jobs = std::vector<SweepJob>();
+    auto choice = std::vector<int>(names.size(), 0);
+    while (true) {
+        auto values = std::map<std::string, std::string>();
+        for (int i = 0; i < names.size(); i++) {
+            values[names[i]] = alternatives[i][choice[i]];
+        }
+        jobs.push_back(parseJob(kind, values, lineNumber));
+
+        int i = 0;
+        for (; (i < names.size()) && (++choice[i] == alternatives[i].size()); i++) {
+            choice[i] = 0;
+        }
+        if (i == names.size()) {
+            return jobs;
+        }
+    }
+}
+
+std::vector<SweepJob> ScenarioSweep::readScenarios(const std::string& scenariosPath) {
+    std::ifstream file(scenariosPath);
+    if (!file) {
+        std::cout << "Cannot open scenario file: " << scenariosPath << std::endl;
+        exit(-1);
+    }
+
+    auto jobs = std::vector<SweepJob>();
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+        auto comment = line.find('#');
+        if (comment != std::string::npos) {
+            line = line.substr(0, comment);
+        }
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        auto lineJobs = expandLine(line, lineNumber);
+        jobs.insert(jobs.end(), lineJobs.begin(), lineJobs.end());
+    }
+    return jobs;
+}
+
+void ScenarioSweep::truncateIncompleteLine(const std::string& resultsPath) {
+    /*
+     * Обрезка недописанной при аварийном завершении последней строки файла результатов,
+     * иначе следующая строка дописалась бы к ней и исказила бы её результат.
+     */
+    std::ifstream file(resultsPath, std::ios::binary);
+    if (!file) {
+        return;
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    file.close();
+    auto text = content.str();
+    auto lastNewline = text.rfind('\n');
+    auto completeSize = (lastNewline == std::string::npos) ? 0 : lastNewline + 1;
+    if (completeSize == text.size()) {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::resize_file(resultsPath, completeSize, error);
+    if (error) {
+        std::cout << "Cannot truncate results file: " << resultsPath << std::endl;
+        exit(-1);
+    }
+}
+
+std::set<std::string> ScenarioSweep::readCompletedJobs(const std::string& resultsPath) {
+    /*
+     * Задача считается решённой, если её строка в файле результатов записана целиком,
+     * то есть заканчивается переводом строки.
+     */
+    auto completedJobs = std::set<std::string>();
+    std::ifstream file(resultsPath);
+    if (!file) {
+        return completedJobs;
+    }
+
+    std::stringstream content;
+    content << file.rdbuf();
+    auto text = content.str();
+    size_t begin = 0;
+    for (auto end = text.find('\n'); end != std::string::npos; end = text.find('\n', begin)) {
+        auto line = text.substr(begin, end - begin);
+        auto tab = line.find('\t');
+        if (tab != std::string::npos) {
+            completedJobs.insert(line.substr(0, tab));
+        }
+        begin = end + 1;
+    }
+    return completedJobs;
+}
+
+std::string ScenarioSweep::formatTeam(const StrengthVector& team) {
+    std::stringstream stream;
+    stream.precision(17);
+    for (int i = 0; i < team.getLength(); i++) {
+        stream << (i > 0 ? "," : "") << team[i];
+    }
+    return stream.str();
+}
+
+std::string ScenarioSweep::runJob(const SweepJob& job,
+                                  const int threadsNumber,
+                                  const std::shared_ptr<SolutionStore>& solutionStore) {
+    auto options = SimulationOptions();
+    options.verbose = false;
+    options.solutionStore = solutionStore;
+    std::stringstream result;
+    result.precision(17);
+
+    if (!job.isTeams) {
+        auto team = Simulation::simulationForOneTeamWithOneEnemy(job.totalStrength, job.gladiatorNumber, job.enemy,
+                                                                 job.generationNumber, job.epochs,
+                                                                 job.mutationCoefficient, threadsNumber, options);
+        result << "probability=" << QualityEstimation::probabilityOfWinLeftTeam(team, job.enemy)
+               << "\tteam=" << formatTeam(team);
+        return result.str();
+    }
+
+    auto teams = Simulation::simulationTeams(job.totalStrengths, job.gladiatorNumbers,
+                                             job.generationNumber, job.epochs,
+                                             job.mutationCoefficient, threadsNumber, options);
+    scoreTeams(teams, options, result);
+    result << "\tteams=";
+    for (int i = 0; i < teams.size(); i++) {
+        result << (i > 0 ? ";" : "") << formatTeam(teams[i]);
+    }
+    return result.str();
+}
+
+void ScenarioSweep::scoreTeams(const std::vector<StrengthVector>& teams, const SimulationOptions& options,
+                               std::stringstream& result) {
+    /*
+     * Вероятности победы итоговых команд тем же способом, что и турниры расчёта
+     * (`Simulation::tournamentBackend`): плотная таблица больших турниров не строится.
+     * Для разреженной оценки дописывается отброшенная масса `dropped`,
+     * для моделирования -- стандартная ошибка `error`.
+     */
+    auto probabilities = std::vector<double>();
+    auto backend = Simulation::tournamentBackend(teams, options);
+    auto droppedMass = -1.0;
+    auto standardError = -1.0;
+    if (backend == TournamentBackend::Sparse) {
+        auto sparseProbabilities = QualityEstimation::probabilitiesOfWinSparse(teams, options.sparseEpsilon,
+                                                                               options.denseStatesLimit);
+        probabilities = std::move(sparseProbabilities.probabilities);
+        droppedMass = sparseProbabilities.droppedMass;
+    } else if (backend == TournamentBackend::MonteCarlo) {
+        auto monteCarlo = options.monteCarlo ? options.monteCarlo : std::make_shared<MonteCarloEstimation>();
+        auto estimate = monteCarlo->probabilitiesOfWin(teams);
+        probabilities = std::move(estimate.probabilities);
+        standardError = estimate.standardError;
+    } else {
+        auto compressedTeams = std::vector<RunLengthTeam>(teams.size());
+        for (int i = 0; i < teams.size(); i++) {
+            compressedTeams[i] = RunLengthTeam(teams[i]);
+        }
+        probabilities = QualityEstimation::probabilitiesOfWin(compressedTeams);
+    }
+
+    result << "probabilities=";
+    for (int i = 0; i < probabilities.size(); i++) {
+        result << (i > 0 ? "," : "") << probabilities[i];
+    }
+    if (droppedMass >= 0) {
+        result << "\tdropped=" << droppedMass;
+    }
+    if (standardError >= 0) {
+        result << "\terror=" << standardError;
+    }
+}
+
+void ScenarioSweep::run(const std::string& scenariosPath,
+                        const std::string& resultsPath,
+                        const int threadsNumber,
+                        const std::shared_ptr<SolutionStore>& solutionStore,
+                        const double largeJobCost) {
+    /**
+     * Прогон всех задач файла сценариев с записью результатов по мере готовности.
+     *
+     * Все задачи выполняются одним `Executor` из `threadsNumber` потоков, у каждой задачи
+     * своя очередь (как у заданий `AsyncSimulation::submit`): небольшие задачи
+     * (оценка стоимости меньше `largeJobCost`) считаются в один поток, большие отправляют
+     * свои параллельные части до `threadsNumber` в свою очередь. Большие задачи ставятся первыми,
+     * и свободные потоки разбирают их части вместе с небольшими задачами, не дожидаясь друг друга.
+     * Каждая готовая задача сразу дописывается строкой `описание<TAB>результат`
+     * в `resultsPath`; задачи, уже записанные туда при прошлом запуске, пропускаются.
+     * Если задано `solutionStore`, каждая задача начинается с решений ближайших
+     * уже решённых сценариев (в том числе решённых раньше в этом прогоне) и сохраняет своё.
+     */
+    auto jobs = readScenarios(scenariosPath);
+    truncateIncompleteLine(resultsPath);
+    auto completedJobs = readCompletedJobs(resultsPath);
+    std::ofstream results(resultsPath, std::ios::app);
+    if (!results) {
+        std::cout << "Cannot open results file: " << resultsPath << std::endl;
+        exit(-1);
+    }
+
+    std::mutex resultsMutex;
+    auto writeResult = [&results, &resultsMutex](const SweepJob& job, const std::string& result) {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        results << job.key << "\t" << result << "\n";
+        results.flush();
+    };
+
+    auto smallJobs = std::vector<const SweepJob*>();
+    auto largeJobs = std::vector<const SweepJob*>();
+    for (auto& job: jobs) {
+        if (completedJobs.count(job.key) == 0) {
+            completedJobs.insert(job.key);
+            (job.cost() < largeJobCost ? smallJobs : largeJobs).push_back(&job);
+        }
+    }
+    std::cout << "Jobs: " << jobs.size() << ", to run: " << smallJobs.size() + largeJobs.size()
+              << " (" << largeJobs.size() << " large)" << std::endl;
+
+    auto executor = Executor(threadsNumber);
+    auto futures = std::vector<std::future<void>>();
+    for (auto group: {&largeJobs, &smallJobs}) {
+        auto jobThreadsNumber = (group == &largeJobs) ? threadsNumber : 1;
+        for (auto job: *group) {
+            auto queue = executor.openQueue();
+            futures.push_back(executor.submit(queue, [job, jobThreadsNumber, queue, &executor, &writeResult,
+                                                      &solutionStore]() {
+                /* Параллельные части задачи уходят в её очередь, а не в отдельные потоки. */
+                struct QueueBinding {
+                    Executor& executor;
+                    int queue;
+                    QueueBinding(Executor& executor, const int queue) : executor(executor), queue(queue) {
+                        Executor::bindCurrentThread(&executor, queue);
+                    }
+                    ~QueueBinding() {
+                        Executor::bindCurrentThread(nullptr, -1);
+                        executor.closeQueue(queue);
+                    }
+                };
+                auto binding = QueueBinding(executor, queue);
+                writeResult(*job, runJob(*job, jobThreadsNumber, solutionStore));
+            }));
+        }
+    }
+    for (auto& future: futures) {
+        future.get();
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef GLADIATORSIMULATION_SCENARIOSWEEP_H
+#define GLADIATORSIMULATION_SCENARIOSWEEP_H
+
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include "../Simulation/Simulation.h"
+#include "../Simulation/Executor.h"
+
+struct SweepJob {
+    // Каноническое описание задачи, по нему пропускаются уже решённые задачи.
+    std::string key;
+    bool isTeams{false};
+    double totalStrength{1};
+    int gladiatorNumber{1};
+    StrengthVector enemy;
+    std::vector<double> totalStrengths;
+    std::vector<int> gladiatorNumbers;
+    int generationNumber{100};
+    int epochs{100};
+    double mutationCoefficient{0.5};
+
+    double cost() const;
+};
+
+class ScenarioSweep {
+public:
+    static std::vector<SweepJob> readScenarios(const std::string& scenariosPath);
+    static void run(const std::string& scenariosPath,
+                    const std::string& resultsPath,
+                    int threadsNumber,
+                    const std::shared_ptr<SolutionStore>& solutionStore=nullptr,
+                    double largeJobCost=1e10);
+private:
+    static std::vector<SweepJob> expandLine(const std::string& line, int lineNumber);
+    static SweepJob parseJob(const std::string& kind, const std::map<std::string, std::string>& values, int lineNumber);
+    static void truncateIncompleteLine(const std::string& resultsPath);
+    static std::set<std::string> readCompletedJobs(const std::string& resultsPath);
+    static std::string runJob(const SweepJob& job, int threadsNumber, const std::shared_ptr<SolutionStore>& solutionStore);
+    static void scoreTeams(const std::vector<StrengthVector>& teams, const SimulationOptions& options,
+                           std::stringstream& result);
+    static std::vector<std::string> split(const std::string& text, char separator);
+    static StrengthVector parseEnemy(const std::string& text, int lineNumber);
+    static double parseDouble(const std::string& text, int lineNumber);
+    static int parseInt(const std::string& text, int lineNumber);
+    static std::string formatTeam(const StrengthVector& team);
+};
+
+
+#endif //GLADIATORSIMULATION_SCENARIOSWEEP_H
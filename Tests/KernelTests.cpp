@@ -0,0 +1,238 @@
+#include <cmath>
+#include <random>
+#include "../Simulation/QualityEstimation.h"
+#include "../Simulation/LargeDuelEstimation.h"
+#include "../Simulation/MonteCarloEstimation.h"
+
+/*
+ * Сравнение ядер оценки с эталоном -- исходным плотным алгоритмом
+ * `QualityEstimation::probabilitiesOfWin` для `StrengthVector` -- на фиксированных входах.
+ * Код возврата -- число непройденных проверок.
+ */
+
+int failuresNumber = 0;
+
+void check(const std::string& name, const double value, const double expected, const double tolerance) {
+    if (!(std::abs(value - expected) <= tolerance)) {
+        std::cout << "FAILED " << name << ": " << value << ", expected " << expected << std::endl;
+        failuresNumber++;
+    }
+}
+
+void check(const std::string& name, const bool condition) {
+    if (!condition) {
+        std::cout << "FAILED " << name << std::endl;
+        failuresNumber++;
+    }
+}
+
+StrengthVector randomTeam(const int length, std::mt19937& randomGenerator) {
+    auto distribution = std::uniform_real_distribution<double>(0.1, 1.0);
+    auto team = StrengthVector(length);
+    for (int i = 0; i < length; i++) {
+        team[i] = distribution(randomGenerator);
+    }
+    return team;
+}
+
+StrengthVector runsTeam(const std::vector<std::pair<int, double>>& runs) {
+    int length = 0;
+    for (auto& run: runs) {
+        length += run.first;
+    }
+    auto team = StrengthVector(length);
+    int i = 0;
+    for (auto& run: runs) {
+        for (int k = 0; k < run.first; k++) {
+            team[i++] = run.second;
+        }
+    }
+    return team;
+}
+
+double reference(const StrengthVector& leftTeam, const StrengthVector& rightTeam) {
+    return QualityEstimation::probabilitiesOfWin({leftTeam, rightTeam})[0];
+}
+
+void checkFloat(std::mt19937& randomGenerator) {
+    for (auto [m, n]: std::vector<std::pair<int, int>>{{1, 1}, {5, 7}, {20, 13}}) {
+        auto left = randomTeam(m, randomGenerator);
+        auto right = randomTeam(n, randomGenerator);
+        auto expected = reference(left, right);
+        check("double duel", QualityEstimation::probabilityOfWinLeftTeam(left, right), expected, 1e-12);
+        check("float duel", QualityEstimation::probabilityOfWinLeftTeam(BasicStrengthVector<float>(left),
+                                                                        BasicStrengthVector<float>(right)),
+              expected, 1e-5);
+    }
+}
+
+void checkRunLength(std::mt19937& randomGenerator) {
+    auto enemy = runsTeam({{5, 0.3}, {1, 0.7}, {8, 0.5}});
+    auto left = randomTeam(9, randomGenerator);
+    auto expected = reference(left, enemy);
+    check("run-length duel", QualityEstimation::probabilityOfWinLeftTeam(left, RunLengthTeam(enemy)), expected, 1e-12);
+    check("run-length float duel", QualityEstimation::probabilityOfWinLeftTeam(BasicStrengthVector<float>(left),
+                                                                               RunLengthTeam(enemy)),
+          expected, 1e-5);
+
+    /* Форма `test()` из main.cpp: 3 гладиатора против 100 одинаковых, серия проходится возведением в степень. */
+    auto smallTeam = randomTeam(3, randomGenerator);
+    for (auto& runs: std::vector<std::vector<std::pair<int, double>>>{{{100, 0.013}}, {{40, 0.2}, {100, 0.05}}}) {
+        auto longEnemy = runsTeam(runs);
+        check("run-length power", QualityEstimation::probabilityOfWinLeftTeam(smallTeam, RunLengthTeam(longEnemy)),
+              reference(smallTeam, longEnemy), 1e-12);
+    }
+
+    auto teams = std::vector<StrengthVector>{runsTeam({{3, 0.4}, {2, 0.2}}), randomTeam(4, randomGenerator),
+                                             runsTeam({{6, 0.25}})};
+    auto expectedTournament = QualityEstimation::probabilitiesOfWin(teams);
+    auto compressedTeams = std::vector<RunLengthTeam>(teams.begin(), teams.end());
+    auto tournament = QualityEstimation::probabilitiesOfWin(compressedTeams);
+    auto floatTournament = QualityEstimation::probabilitiesOfWin<float>(compressedTeams);
+    for (int j = 0; j < teams.size(); j++) {
+        check("run-length tournament", tournament[j], expectedTournament[j], 1e-12);
+        check("run-length float tournament", floatTournament[j], expectedTournament[j], 1e-5);
+    }
+}
+
+void checkSparse(std::mt19937& randomGenerator) {
+    auto teams = std::vector<StrengthVector>{randomTeam(5, randomGenerator), randomTeam(4, randomGenerator),
+                                             randomTeam(6, randomGenerator), randomTeam(3, randomGenerator)};
+    auto expected = QualityEstimation::probabilitiesOfWin(teams);
+    auto sparse = QualityEstimation::probabilitiesOfWinSparse(teams, 0);
+    check("sparse dropped mass", sparse.droppedMass == 0);
+    for (int j = 0; j < teams.size(); j++) {
+        check("sparse tournament", sparse.probabilities[j], expected[j], 1e-12);
+    }
+
+    /* С ограниченным фронтом точная вероятность лежит в [p_j, p_j + droppedMass]. */
+    auto bounded = QualityEstimation::probabilitiesOfWinSparse(teams, 0, 20);
+    check("bounded sparse drops mass", bounded.droppedMass > 0);
+    for (int j = 0; j < teams.size(); j++) {
+        check("bounded sparse", (bounded.probabilities[j] <= expected[j] + 1e-12)
+                                && (expected[j] <= bounded.probabilities[j] + bounded.droppedMass + 1e-12));
+    }
+}
+
+void checkSurvivors(std::mt19937& randomGenerator) {
+    auto left = randomTeam(6, randomGenerator);
+    auto right = randomTeam(8, randomGenerator);
+    auto survivors = QualityEstimation::survivalProbabilities(left, right);
+    auto swappedSurvivors = QualityEstimation::survivalProbabilities(right, left);
+    double total = 0;
+    double leftWins = 0;
+    for (int k = 0; k < survivors.size(); k++) {
+        total += survivors[k];
+        if (k < left.getLength()) {
+            leftWins += survivors[k];
+        }
+    }
+    check("survivors total", total, 1, 1e-12);
+    check("survivors win probability", leftWins, reference(left, right), 1e-12);
+    for (int k = 0; k < left.getLength(); k++) {
+        check("survivors symmetry", survivors[k], swappedSurvivors[right.getLength() + k], 1e-12);
+    }
+
+    auto single = QualityEstimation::survivalProbabilities(runsTeam({{1, 0.3}}), runsTeam({{1, 0.6}}));
+    check("single survivor", single[0], 1.0 / 3, 1e-15);
+    check("single survivor", single[1], 2.0 / 3, 1e-15);
+}
+
+void checkLargeDuel(std::mt19937& randomGenerator) {
+    /* Маленькие плитки, чтобы проверить границы между ними. */
+    auto left = randomTeam(300, randomGenerator);
+    auto right = randomTeam(317, randomGenerator);
+    auto expected = reference(left, right);
+    check("large duel", LargeDuelEstimation::probabilityOfWinLeftTeam(left, right, 2, 64), expected, 1e-12);
+    check("large duel log", LargeDuelEstimation::logProbabilityOfWinLeftTeam(left, right, 1, 100),
+          std::log(expected), 1e-9);
+
+    /* Вероятность ниже наименьшего double: линейное ядро даёт 0, логарифм остаётся конечным. */
+    auto weakTeam = runsTeam({{400, 0.1}});
+    auto strongTeam = runsTeam({{600, 1.0}});
+    auto logProbability = LargeDuelEstimation::logProbabilityOfWinLeftTeam(weakTeam, strongTeam, 2, 128);
+    check("large duel underflow", std::isfinite(logProbability) && (logProbability < -745));
+}
+
+void checkBatchedDuels(std::mt19937& randomGenerator) {
+    /* 19 поединков: два полных блока по 8 и неполный, длины команд в пакете разные. */
+    auto leftTeams = std::vector<StrengthVector>();
+    auto rightTeams = std::vector<StrengthVector>();
+    for (int d = 0; d < 19; d++) {
+        leftTeams.push_back(randomTeam(6 + d % 3, randomGenerator));
+        rightTeams.push_back(randomTeam(11, randomGenerator));
+    }
+    auto batch = QualityEstimation::probabilitiesOfWinLeftTeam(leftTeams, rightTeams, 2);
+    for (int d = 0; d < leftTeams.size(); d++) {
+        check("batched duels", batch[d], reference(leftTeams[d], rightTeams[d]), 1e-12);
+    }
+}
+
+void checkStridedDuels(std::mt19937& randomGenerator) {
+    /* 13 команд подряд в одном массиве против одного противника (нулевой шаг). */
+    int m = 7;
+    int n = 10;
+    int duelsNumber = 13;
+    auto left = std::vector<double>();
+    auto enemy = randomTeam(n, randomGenerator);
+    for (int d = 0; d < duelsNumber; d++) {
+        auto team = randomTeam(m, randomGenerator);
+        left.insert(left.end(), team.getData(), team.getData() + m);
+    }
+    auto result = std::vector<double>(duelsNumber);
+    QualityEstimation::probabilitiesOfWinLeftTeam(left.data(), m, m, enemy.getData(), n, 0, duelsNumber,
+                                                  result.data(), 2);
+    auto team = StrengthVector(m);
+    for (int d = 0; d < duelsNumber; d++) {
+        for (int j = 0; j < m; j++) {
+            team[j] = left[d * m + j];
+        }
+        check("strided duels", result[d], reference(team, enemy), 1e-12);
+    }
+}
+
+void checkPreparedOpponent(std::mt19937& randomGenerator) {
+    /* Длины команд чередуются блоками, так что есть и полные блоки по 8, и одиночные команды. */
+    auto enemy = randomTeam(10, randomGenerator);
+    auto teams = std::vector<StrengthVector>();
+    for (int d = 0; d < 21; d++) {
+        teams.push_back(randomTeam((d < 9) ? 7 : ((d == 9) ? 4 : 6), randomGenerator));
+    }
+    auto result = std::vector<double>(teams.size());
+    auto prepared = PreparedOpponent(enemy);
+    QualityEstimation::probabilitiesOfWinLeftTeam(teams.data(), teams.size(), prepared, result.data());
+    for (int d = 0; d < teams.size(); d++) {
+        check("prepared opponent duels", result[d], reference(teams[d], enemy), 1e-12);
+    }
+}
+
+void checkMonteCarlo(std::mt19937& randomGenerator) {
+    /* Случайные числа определяются зерном, поэтому проверка с запасом в 4 стандартные ошибки не плавает. */
+    auto teams = std::vector<StrengthVector>{randomTeam(4, randomGenerator), randomTeam(3, randomGenerator),
+                                             randomTeam(5, randomGenerator)};
+    auto expected = QualityEstimation::probabilitiesOfWin(teams);
+    auto monteCarlo = MonteCarloEstimation(2e-3, 1LL << 22, 2);
+    auto estimate = monteCarlo.probabilitiesOfWin(teams);
+    check("monte carlo standard error", (estimate.standardError > 0) && (estimate.standardError <= 2e-3));
+    for (int j = 0; j < teams.size(); j++) {
+        check("monte carlo tournament", estimate.probabilities[j], expected[j], 4 * estimate.standardError);
+    }
+
+    auto duel = monteCarlo.probabilityOfWinLeftTeam(teams[0], teams[2]);
+    check("monte carlo duel", duel.probabilities[0], reference(teams[0], teams[2]), 4 * duel.standardError);
+}
+
+int main() {
+    auto randomGenerator = std::mt19937(20201114);
+    checkFloat(randomGenerator);
+    checkRunLength(randomGenerator);
+    checkSparse(randomGenerator);
+    checkSurvivors(randomGenerator);
+    checkLargeDuel(randomGenerator);
+    checkBatchedDuels(randomGenerator);
+    checkStridedDuels(randomGenerator);
+    checkPreparedOpponent(randomGenerator);
+    checkMonteCarlo(randomGenerator);
+    std::cout << (failuresNumber == 0 ? "All kernel checks passed" : "Some kernel checks failed") << std::endl;
+    return failuresNumber;
+}
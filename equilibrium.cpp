@@ -0,0 +1,50 @@
+#include <chrono>
+#include <sstream>
+#include "Simulation/EquilibriumSolver.h"
+
+template <typename Number>
+std::vector<Number> parseList(const std::string& list) {
+    /* Список чисел через запятую: "1,1.2,1.4". */
+    auto result = std::vector<Number>();
+    auto stream = std::stringstream(list);
+    auto item = std::string();
+    while (std::getline(stream, item, ',')) {
+        result.push_back((Number) std::atof(item.c_str()));
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0]
+                  << " <total strengths, comma separated> <gladiator numbers, comma separated>"
+                  << " [rounds] [max support size] [threads number]" << std::endl;
+        return -1;
+    }
+
+    auto totalStrengths = parseList<double>(argv[1]);
+    auto gladiatorNumbers = parseList<int>(argv[2]);
+    int rounds = (argc > 3) ? std::atoi(argv[3]) : 20;
+    int maxSupportSize = (argc > 4) ? std::atoi(argv[4]) : 8;
+    int threadsNumber = (argc > 5) ? std::atoi(argv[5]) : (int) std::thread::hardware_concurrency();
+    if ((threadsNumber <= 0) || (threadsNumber > std::thread::hardware_concurrency())) {
+        std::cout << "There is wrong number" << threadsNumber << std::endl;
+        exit(-1);
+    }
+
+    auto start_time =  std::chrono::system_clock::now();
+    auto result = EquilibriumSolver::solve(totalStrengths, gladiatorNumbers, rounds, maxSupportSize,
+                                           50, 50, 0.5, threadsNumber);
+    auto end_time =  std::chrono::system_clock::now();
+
+    std::cout << "***** EQUILIBRIUM *****" << std::endl;
+    for (int h = 0; h < result.profiles.size(); h++) {
+        std::cout << "Profile " << h << ", weight " << result.weights[h] << std::endl;
+        for (auto& team: result.profiles[h]) {
+            team.print();
+        }
+    }
+    std::chrono::duration<double> diff = end_time - start_time;
+    std::cout << "Time work: " << diff.count() << " s" << std::endl;
+    return 0;
+}
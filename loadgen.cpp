@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include "Server/WinProbabilityProtocol.h"
+
+int main(int argc, char* argv[]) {
+    /**
+     * Генератор нагрузки для GladiatorServer.
+     *
+     * Каждое из `connections` соединений отправляет `requests` запросов по одному,
+     * дожидаясь ответа (замкнутый цикл), в каждом запросе `teams` случайных команд
+     * по `gladiators` гладиаторов. Печатаются пропускная способность и квантили задержки.
+     */
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0]
+                  << " <socket path> [connections] [requests per connection] [gladiators] [teams]" << std::endl;
+        return -1;
+    }
+    int connectionsNumber = (argc > 2) ? std::atoi(argv[2]) : 16;
+    int requestsNumber = (argc > 3) ? std::atoi(argv[3]) : 1000;
+    int gladiatorNumber = (argc > 4) ? std::atoi(argv[4]) : 10;
+    int teamsNumber = (argc > 5) ? std::atoi(argv[5]) : 2;
+    if ((connectionsNumber <= 0) || (requestsNumber <= 0) || (gladiatorNumber <= 0) || (teamsNumber <= 0)) {
+        std::cout << "There is wrong number" << std::endl;
+        exit(-1);
+    }
+
+    auto latencies = std::vector<std::vector<double>>(connectionsNumber);
+    auto failures = std::vector<int>(connectionsNumber, 0);
+    auto clients = std::vector<std::thread>();
+    auto start_time = std::chrono::steady_clock::now();
+    for (int c = 0; c < connectionsNumber; c++) {
+        clients.emplace_back([&latencies, &failures, &argv, c, requestsNumber, gladiatorNumber, teamsNumber]() {
+            auto descriptor = WinProbabilityProtocol::connect(argv[1]);
+            auto randomGenerator = std::mt19937(c);
+            auto strengthDistribution = std::uniform_real_distribution<double>(0.1, 1.0);
+            auto teams = std::vector<StrengthVector>(teamsNumber, StrengthVector(gladiatorNumber));
+            auto frame = std::vector<char>();
+            auto probabilities = std::vector<double>();
+            latencies[c].reserve(requestsNumber);
+
+            for (uint32_t r = 0; r < requestsNumber; r++) {
+                for (auto& team: teams) {
+                    for (int i = 0; i < gladiatorNumber; i++) {
+                        team[i] = strengthDistribution(randomGenerator);
+                    }
+                }
+                auto request_time = std::chrono::steady_clock::now();
+                uint32_t id;
+                double droppedMass;
+                if (!WinProbabilityProtocol::writeFrame(descriptor, WinProbabilityProtocol::encodeRequest(r, teams))
+                    || !WinProbabilityProtocol::readFrame(descriptor, frame)
+                    || !WinProbabilityProtocol::decodeResponse(frame, id, probabilities, droppedMass)
+                    || (id != r) || (probabilities.size() != teamsNumber)) {
+                    failures[c]++;
+                    break;
+                }
+                std::chrono::duration<double, std::micro> latency = std::chrono::steady_clock::now() - request_time;
+                latencies[c].push_back(latency.count());
+            }
+            close(descriptor);
+        });
+    }
+    for (auto& client: clients) {
+        client.join();
+    }
+    std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start_time;
+
+    auto allLatencies = std::vector<double>();
+    for (int c = 0; c < connectionsNumber; c++) {
+        allLatencies.insert(allLatencies.end(), latencies[c].begin(), latencies[c].end());
+        if (failures[c] > 0) {
+            std::cout << "Connection " << c << " failed after " << latencies[c].size() << " requests" << std::endl;
+        }
+    }
+    if (allLatencies.empty()) {
+        return -1;
+    }
+    std::sort(allLatencies.begin(), allLatencies.end());
+    auto quantile = [&allLatencies](const double level) {
+        return allLatencies[std::min<size_t>(allLatencies.size() - 1, (size_t) (level * allLatencies.size()))];
+    };
+
+    std::cout << "Requests: " << allLatencies.size() << ", time: " << diff.count() << " s" << std::endl;
+    std::cout << "Throughput: " << allLatencies.size() / diff.count() << " requests/s" << std::endl;
+    std::cout << "Latency p50: " << quantile(0.5) << " us, p99: " << quantile(0.99)
+              << " us, max: " << allLatencies.back() << " us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include <csignal>
+#include "Server/WinProbabilityServer.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0]
+                  << " <socket path> [threads number] [batch window, us] [max batch size] [max query cost]" << std::endl;
+        return -1;
+    }
+
+    int threadsNumber = (argc > 2) ? std::atoi(argv[2]) : (int) std::thread::hardware_concurrency();
+    if ((threadsNumber <= 0) || (threadsNumber > std::thread::hardware_concurrency())) {
+        std::cout << "There is wrong number" << threadsNumber << std::endl;
+        exit(-1);
+    }
+    auto batchWindow = std::chrono::microseconds((argc > 3) ? std::atoll(argv[3]) : 200);
+    int maxBatchSize = (argc > 4) ? std::atoi(argv[4]) : 1024;
+    long long maxQueryCost = (argc > 5) ? std::atoll(argv[5]) : 1LL << 30;
+
+    /* SIGINT и SIGTERM принимаются отдельным потоком, который останавливает сервер. */
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    auto server = WinProbabilityServer(argv[1], threadsNumber, batchWindow, maxBatchSize, 1LL << 22, maxQueryCost);
+    auto signalWaiter = std::thread([&server, &signals]() {
+        int signal;
+        sigwait(&signals, &signal);
+        server.stop();
+    });
+    signalWaiter.detach();
+
+    std::cout << "Listening on " << argv[1] << std::endl;
+    server.run();
+    std::cout << "Queries: " << server.getQueriesNumber() << ", batches: " << server.getBatchesNumber() << std::endl;
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include <chrono>
+#include "Sweep/ScenarioSweep.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <scenarios file> <results file> [threads number] [solution store file]"
+                  << std::endl;
+        return -1;
+    }
+
+    int threadsNumber = (argc > 3) ? std::atoi(argv[3]) : (int) std::thread::hardware_concurrency();
+    if ((threadsNumber <= 0) || (threadsNumber > std::thread::hardware_concurrency())) {
+        std::cout << "There is wrong number" << threadsNumber << std::endl;
+        exit(-1);
+    }
+
+    /* Хранилище решений для тёплого старта соседних сценариев, по умолчанию не используется. */
+    auto solutionStore = (argc > 4) ? std::make_shared<SolutionStore>(argv[4]) : nullptr;
+
+    auto start_time =  std::chrono::system_clock::now();
+    ScenarioSweep::run(argv[1], argv[2], threadsNumber, solutionStore);
+    auto end_time =  std::chrono::system_clock::now();
+    std::chrono::duration<double> diff = end_time - start_time;
+    std::cout << "Time work: " << diff.count() << " s" << std::endl;
+    return 0;
+}
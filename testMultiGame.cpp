@@ -4,16 +4,19 @@
 
 #include <chrono>
 #include "Simulation/Simulation.h"
+#include "Simulation/Autotuner.h"
 
-int main() {
+int main(int argc, char* argv[]) {
     auto totalStrengths = std::vector<double>{1, 1.2, 1.4};
     auto gladiatorNumbers = std::vector<int>{5, 6, 7};
-    int threadsNumber = 8;
 
-    if ((threadsNumber <= 0) || (threadsNumber > std::thread::hardware_concurrency())) {
-        std::cout << "There is wrong number" << threadsNumber << std::endl;
-        exit(-1);
-    }
+    /* Число потоков и точность подбирает Autotuner; `--retune` заново измеряет конфигурации. */
+    auto autotuneOptions = AutotuneOptions();
+    autotuneOptions.forceRetune = (argc > 1) && (std::string(argv[1]) == "--retune");
+    auto configuration = Autotuner::tuneTeams(gladiatorNumbers, autotuneOptions);
+    auto options = SimulationOptions();
+    Autotuner::apply(configuration, options);
+    int threadsNumber = configuration.threadsNumber;
 
     auto start_time =  std::chrono::system_clock::now();
     auto optimalTeams = Simulation::simulationTeams(totalStrengths,
@@ -21,7 +24,8 @@ int main() {
                                                     75,
                                                     75,
                                                     0.95,
-                                                    threadsNumber);
+                                                    threadsNumber,
+                                                    options);
     auto end_time =  std::chrono::system_clock::now();
     std::chrono::duration<double> diff = end_time - start_time;
     std::cout << "Time work: " << diff.count() << " s" << std::endl;